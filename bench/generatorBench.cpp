@@ -0,0 +1,307 @@
+#include <benchmark/benchmark.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include "../include/tilesMap.h"
+#include "../include/tileSetManifest.h"
+#include "../include/overlappingModel.h"
+#include "../include/bitOps.h"
+
+//benchmarks of the hot paths on bundled tile sets data/set_1 and data/set_2
+//generation is measured on tile sets with sides, weights and symmetries of manifests and 1x1 images,
+//so big maps don't spend time and memory on rendering, rendering is measured on real images
+namespace{
+    enum GenerationMode : int64_t{
+        GREEDY = 0,
+        WFC,
+        PARALLEL
+    };
+
+    constexpr int64_t MAX_RENDER_BYTES = int64_t(1) << 28; //biggest image of rendering benchmarks
+    constexpr int64_t MAX_EXPORT_BYTES = int64_t(1) << 26; //biggest image of export benchmarks
+
+    std::string manifestPath(int64_t set){
+        return std::string(MAPGEN_DATA_DIR) + "/set_" + std::to_string(set) + "/manifest.txt";
+    }
+
+    //tile set of manifest with 1x1 images of different colors
+    TileSet createSidesTileSet(int64_t set){
+        const TileSetManifest manifest(manifestPath(set));
+        TileSet tileSet(manifest.getFeaturesCount(), {1, 1});
+        tileSet.setCompatibility(manifest.getCompatibility());
+        int color = 0;
+        for(const auto& tile: manifest.getTiles()){
+            TileImage img;
+            img.getImage() = cv::Mat(1, 1, CV_8UC4, cv::Scalar(color, 255 - color, 128, 255));
+            color += 16;
+            tileSet.addTile(Tile(img, TileSides(manifest.getFeaturesCount(), tile.sides), tile.weight), tile.symmetry);
+        }
+        tileSet.getAdjacency();
+        return tileSet;
+    }
+
+    //tile sets are loaded once for all benchmarks
+    TileSet& getTileSet(int64_t set, bool images){
+        static std::map<std::pair<int64_t, bool>, std::unique_ptr<TileSet>> tileSets;
+        auto& tileSet = tileSets[{set, images}];
+        if(!tileSet){
+            tileSet = std::make_unique<TileSet>(images ? TileSetManifest(manifestPath(set)).createTileSet()
+                                                       : createSidesTileSet(set));
+            tileSet->getAdjacency();
+        }
+        return *tileSet;
+    }
+
+    void setCellsCounters(benchmark::State& state, int64_t cells, size_t contradictions, size_t holes){
+        state.SetItemsProcessed(state.iterations() * cells);
+        state.counters["cells/s"] = benchmark::Counter(static_cast<double>(cells), benchmark::Counter::kIsIterationInvariantRate);
+        state.counters["contradictions"] = benchmark::Counter(static_cast<double>(contradictions), benchmark::Counter::kAvgIterations);
+        state.counters["holes"] = benchmark::Counter(static_cast<double>(holes), benchmark::Counter::kAvgIterations);
+    }
+
+    size_t countHoles(const TileIdGrid& map){
+        const cv::Size size = map.getSize();
+        size_t holes = 0;
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                holes += map.get(x, y) == 0;
+            }
+        }
+        return holes;
+    }
+
+    //maps of sizes which images fit maxBytes
+    void imageSizes(benchmark::internal::Benchmark* bench, int64_t maxBytes){
+        for(int64_t set: {1, 2}){
+            const cv::Size tileSize = TileSetManifest(manifestPath(set)).getTileSize();
+            for(int64_t size = 64; size * size * tileSize.area() * 4 <= maxBytes; size *= 2){
+                bench->Args({set, size});
+            }
+        }
+    }
+
+    void renderSizes(benchmark::internal::Benchmark* bench){
+        imageSizes(bench, MAX_RENDER_BYTES);
+    }
+
+    void exportSizes(benchmark::internal::Benchmark* bench){
+        imageSizes(bench, MAX_EXPORT_BYTES);
+    }
+
+    //powers of two up to count of hardware threads on set_2
+    void threadCounts(benchmark::internal::Benchmark* bench){
+        const int64_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        for(int64_t size: {256, 1024}){
+            for(int64_t threads = 1; ; threads *= 2){
+                bench->Args({2, size, std::min(threads, hardware)});
+                if(threads >= hardware) break;
+            }
+        }
+    }
+
+    //overlapping model of noisy stripes, it has several hundred patterns
+    //so domains are wider than specialised kernels and propagation runs on BitOps
+    TileSet& getLargeTileSet(){
+        static std::unique_ptr<TileSet> tileSet;
+        if(!tileSet){
+            cv::Mat sample(48, 48, CV_8UC3);
+            std::mt19937 random(1);
+            for(int y = 0; y < sample.rows; y++){
+                for(int x = 0; x < sample.cols; x++){
+                    const int color = (x / 3 + y / 4 + (random() % 60 == 0)) % 3;
+                    sample.at<cv::Vec3b>(y, x) = cv::Vec3b(color * 100, 255 - color * 100, 128);
+                }
+            }
+            tileSet = std::make_unique<TileSet>(OverlappingModel(sample).createTileSet());
+            tileSet->getAdjacency();
+        }
+        return *tileSet;
+    }
+}
+
+//loading images of manifest and building of tile set with all variants of tiles
+static void BM_TileSetLoad(benchmark::State& state){
+    const std::string path = manifestPath(state.range(0));
+    size_t tiles = 0;
+    for(auto _: state){
+        TileSet tileSet = TileSetManifest(path).createTileSet(1);
+        tiles = tileSet.getAdjacency().getTilesCount();
+    }
+    state.counters["tiles"] = static_cast<double>(tiles);
+}
+BENCHMARK(BM_TileSetLoad)->ArgName("set")->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+//building of index of sides
+static void BM_AdjacencyBuild(benchmark::State& state){
+    TileSet& tileSet = getTileSet(state.range(0), true);
+    const size_t tilesCount = tileSet.getAdjacency().getTilesCount();
+    std::vector<std::array<std::string, 4>> sides;
+    for(size_t i = 0; i < tilesCount; i++){
+        sides.push_back(tileSet.getTileById(i).getSides());
+    }
+
+    for(auto _: state){
+        TileAdjacency adjacency;
+        adjacency.build(sides, tileSet.getCompatibility());
+        benchmark::DoNotOptimize(adjacency.getMask(0, 0));
+    }
+    state.counters["tiles"] = static_cast<double>(tilesCount);
+}
+BENCHMARK(BM_AdjacencyBuild)->ArgName("set")->Arg(1)->Arg(2);
+
+//candidates for random sides of neighbours, some neighbours are missing
+static void BM_CandidateQuery(benchmark::State& state){
+    TileSet& tileSet = getTileSet(state.range(0), true);
+    const TileAdjacency& adjacency = tileSet.getAdjacency();
+
+    std::mt19937 random(1);
+    std::vector<std::array<std::string, 4>> queries(1024);
+    for(auto& query: queries){
+        for(auto& side: query){
+            const size_t id = random() % (adjacency.getSidesCount() + 1);
+            side = id < adjacency.getSidesCount() ? adjacency.getSideName(id) : "";
+        }
+    }
+
+    size_t i = 0;
+    size_t found = 0;
+    for(auto _: state){
+        const auto ids = tileSet.getTilesIdBySides(queries[i++ % queries.size()].data());
+        found += ids.size();
+        benchmark::DoNotOptimize(ids.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["candidates"] = benchmark::Counter(static_cast<double>(found), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_CandidateQuery)->ArgName("set")->Arg(1)->Arg(2);
+
+//whole generation of map, time per cell is cost of one step
+static void BM_GenerateMap(benchmark::State& state){
+    TileSet& tileSet = getTileSet(state.range(0), false);
+    const GenerationMode mode = static_cast<GenerationMode>(state.range(1));
+    const int size = static_cast<int>(state.range(2));
+
+    TileMapGenerator generator;
+    WfcSolver wfcSolver(tileSet);
+    std::unique_ptr<ParallelSolver> parallelSolver;
+    if(mode == PARALLEL) parallelSolver = std::make_unique<ParallelSolver>(tileSet);
+    TileIdGrid map;
+
+    uint64_t seed = 0;
+    size_t contradictions = 0;
+    size_t holes = 0;
+    for(auto _: state){
+        if(mode == GREEDY){
+            generator.generateMap(tileSet, {size, size}, seed++);
+            holes += countHoles(generator.getTileMap());
+        }
+        else if(mode == WFC){
+            wfcSolver.reset({size, size});
+            const WfcStats stats = wfcSolver.run(seed++);
+            contradictions += stats.contradictions;
+            holes += stats.holes;
+        }
+        else{
+            const WfcStats stats = parallelSolver->solve(map, {size, size}, seed++);
+            contradictions += stats.contradictions;
+            holes += stats.holes;
+        }
+    }
+    setCellsCounters(state, static_cast<int64_t>(size) * size, contradictions, holes);
+}
+BENCHMARK(BM_GenerateMap)->ArgNames({"set", "mode", "size"})
+    ->ArgsProduct({{1, 2}, {GREEDY, WFC, PARALLEL}, benchmark::CreateRange(64, 2048, 2)})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//wave function collapse on tile set with several hundred tiles with and without vector instructions
+static void BM_GenerateLargeSet(benchmark::State& state){
+    TileSet& tileSet = getLargeTileSet();
+    const bool simd = state.range(0) != 0;
+    const int size = static_cast<int>(state.range(1));
+    WfcConfig config;
+    config.simd = simd;
+    WfcSolver solver(tileSet, config);
+
+    uint64_t seed = 0;
+    size_t contradictions = 0;
+    size_t holes = 0;
+    for(auto _: state){
+        solver.reset({size, size});
+        const WfcStats stats = solver.run(seed++);
+        contradictions += stats.contradictions;
+        holes += stats.holes;
+    }
+    setCellsCounters(state, static_cast<int64_t>(size) * size, contradictions, holes);
+    state.counters["tiles"] = static_cast<double>(tileSet.getAdjacency().getTilesCount());
+    state.SetLabel(simd ? BitOps::best().name : BitOps::scalar().name);
+}
+BENCHMARK(BM_GenerateLargeSet)->ArgNames({"simd", "size"})->ArgsProduct({{0, 1}, {16, 32}})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//parallel generation on different count of threads
+static void BM_GenerateThreads(benchmark::State& state){
+    TileSet& tileSet = getTileSet(state.range(0), false);
+    const int size = static_cast<int>(state.range(1));
+    ParallelConfig config;
+    config.threads = static_cast<size_t>(state.range(2));
+    ParallelSolver solver(tileSet, config);
+    TileIdGrid map;
+
+    uint64_t seed = 0;
+    size_t contradictions = 0;
+    size_t holes = 0;
+    for(auto _: state){
+        const WfcStats stats = solver.solve(map, {size, size}, seed++);
+        contradictions += stats.contradictions;
+        holes += stats.holes;
+    }
+    setCellsCounters(state, static_cast<int64_t>(size) * size, contradictions, holes);
+}
+BENCHMARK(BM_GenerateThreads)->ArgNames({"set", "size", "threads"})->Apply(threadCounts)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//rendering of generated map with images of tiles
+static void BM_Render(benchmark::State& state){
+    TileSet& tileSet = getTileSet(state.range(0), true);
+    const int size = static_cast<int>(state.range(1));
+    TileIdGrid map;
+    ParallelSolver(tileSet).solve(map, {size, size}, 0);
+
+    TileRenderer renderer;
+    renderer.build(tileSet, tileSet.getAdjacency().getTilesCount());
+    cv::Mat image;
+    for(auto _: state){
+        renderer.render(map, image);
+        benchmark::DoNotOptimize(image.data);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(image.total() * image.elemSize()));
+    state.counters["cells/s"] = benchmark::Counter(static_cast<double>(size) * size, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Render)->ArgNames({"set", "size"})->Apply(renderSizes)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//encoding of rendered map to png
+static void BM_ExportPng(benchmark::State& state){
+    TileSet& tileSet = getTileSet(state.range(0), true);
+    const int size = static_cast<int>(state.range(1));
+    TileIdGrid map;
+    ParallelSolver(tileSet).solve(map, {size, size}, 0);
+
+    TileRenderer renderer;
+    renderer.build(tileSet, tileSet.getAdjacency().getTilesCount());
+    cv::Mat image;
+    renderer.render(map, image);
+
+    std::vector<uint8_t> buffer;
+    for(auto _: state){
+        cv::imencode(".png", image, buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(image.total() * image.elemSize()));
+    state.counters["png bytes"] = static_cast<double>(buffer.size());
+    state.counters["cells/s"] = benchmark::Counter(static_cast<double>(size) * size, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_ExportPng)->ArgNames({"set", "size"})->Apply(exportSizes)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
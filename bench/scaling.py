@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# scaling curves of generator over map size and count of threads
+# runs generatorBench, writes csv tables and compares them with previous run:
+#   bench/scaling.py --bench build/generatorBench --out scaling [--baseline old/scaling.json]
+import argparse
+import csv
+import json
+import os
+import subprocess
+import sys
+
+MODES = {0: "greedy", 1: "wfc", 2: "parallel"}
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="scaling curves of generator over map size and threads")
+    parser.add_argument("--bench", default="build/generatorBench", help="path of generatorBench")
+    parser.add_argument("--out", default="scaling", help="directory for results")
+    parser.add_argument("--filter", default="BM_Generate(Map|Threads)", help="benchmarks which are run")
+    parser.add_argument("--repetitions", type=int, default=3, help="repetitions of every benchmark")
+    parser.add_argument("--baseline", help="scaling.json of previous run for comparison")
+    parser.add_argument("--threshold", type=float, default=0.1, help="relative slowdown which is regression")
+    return parser.parse_args()
+
+
+def run_bench(args, json_path):
+    subprocess.run([args.bench,
+                    "--benchmark_filter=" + args.filter,
+                    "--benchmark_repetitions=" + str(args.repetitions),
+                    "--benchmark_report_aggregates_only=true",
+                    "--benchmark_out_format=json",
+                    "--benchmark_out=" + json_path], check=True)
+
+
+# median of every benchmark by its arguments, name is like BM_GenerateMap/set:2/mode:1/size:256/real_time
+def load_results(json_path):
+    with open(json_path) as file:
+        data = json.load(file)
+    results = {}
+    for bench in data["benchmarks"]:
+        if bench.get("aggregate_name", "median") != "median":
+            continue
+        parts = bench["run_name"].split("/")
+        params = {}
+        for part in parts[1:]:
+            if ":" in part:
+                name, value = part.split(":")
+                params[name] = int(value)
+        results[bench["run_name"]] = {
+            "benchmark": parts[0],
+            "params": params,
+            "time_ms": bench["real_time"] * {"ns": 1e-6, "us": 1e-3, "ms": 1, "s": 1e3}[bench["time_unit"]],
+            "cells_per_s": bench.get("cells/s", 0),
+            "contradictions": bench.get("contradictions", 0),
+            "holes": bench.get("holes", 0),
+        }
+    return results
+
+
+def write_size_scaling(results, path):
+    rows = [r for r in results.values() if r["benchmark"] == "BM_GenerateMap"]
+    rows.sort(key=lambda r: (r["params"]["set"], r["params"]["mode"], r["params"]["size"]))
+    with open(path, "w", newline="") as file:
+        writer = csv.writer(file)
+        writer.writerow(["set", "mode", "size", "cells", "time_ms", "cells_per_s", "contradictions", "holes"])
+        for r in rows:
+            p = r["params"]
+            writer.writerow([p["set"], MODES.get(p["mode"], p["mode"]), p["size"], p["size"] ** 2,
+                             "%.3f" % r["time_ms"], "%.0f" % r["cells_per_s"], r["contradictions"], r["holes"]])
+    return rows
+
+
+def write_thread_scaling(results, path):
+    rows = [r for r in results.values() if r["benchmark"] == "BM_GenerateThreads"]
+    rows.sort(key=lambda r: (r["params"]["size"], r["params"]["threads"]))
+    single = {r["params"]["size"]: r["cells_per_s"] for r in rows if r["params"]["threads"] == 1}
+    with open(path, "w", newline="") as file:
+        writer = csv.writer(file)
+        writer.writerow(["size", "threads", "time_ms", "cells_per_s", "speedup", "efficiency"])
+        for r in rows:
+            p = r["params"]
+            speedup = r["cells_per_s"] / single[p["size"]] if single.get(p["size"]) else 0
+            writer.writerow([p["size"], p["threads"], "%.3f" % r["time_ms"], "%.0f" % r["cells_per_s"],
+                             "%.2f" % speedup, "%.2f" % (speedup / p["threads"])])
+    return rows
+
+
+# benchmarks whose throughput fell more than threshold
+def compare(results, baseline, threshold):
+    regressions = []
+    for name, r in results.items():
+        old = baseline.get(name)
+        if not old or not old["cells_per_s"] or not r["cells_per_s"]:
+            continue
+        change = r["cells_per_s"] / old["cells_per_s"] - 1
+        if change < -threshold:
+            regressions.append((name, old["cells_per_s"], r["cells_per_s"], change))
+    return regressions
+
+
+def main():
+    args = parse_args()
+    os.makedirs(args.out, exist_ok=True)
+    json_path = os.path.join(args.out, "scaling.json")
+    run_bench(args, json_path)
+
+    results = load_results(json_path)
+    sizes = write_size_scaling(results, os.path.join(args.out, "size_scaling.csv"))
+    threads = write_thread_scaling(results, os.path.join(args.out, "thread_scaling.csv"))
+    print("%d size points, %d thread points are written to %s" % (len(sizes), len(threads), args.out))
+
+    if args.baseline:
+        regressions = compare(results, load_results(args.baseline), args.threshold)
+        for name, old, new, change in regressions:
+            print("regression: %s %.0f -> %.0f cells/s (%+.1f%%)" % (name, old, new, change * 100))
+        if regressions:
+            return 1
+        print("no regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
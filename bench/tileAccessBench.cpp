@@ -0,0 +1,103 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include "../include/tilesMap.h"
+
+//counts every heap allocation of the process, profiling build counts them by itself
+namespace{
+#ifdef WFC_ENABLE_PROFILING
+    size_t allocationsCount(){
+        return Profiler::getAllocationsCount();
+    }
+#else
+    std::atomic<size_t> allocations{0};
+
+    size_t allocationsCount(){
+        return allocations.load(std::memory_order_relaxed);
+    }
+#endif
+
+    double nowSeconds(){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //tile set with sides of data/set_2, images are filled by color, so files aren't needed
+    void fillTileSet(TileSet& tileSet){
+        const char* sides[] = {"0000", "1010", "0110", "1111", "1110", "0010"};
+        const uint32_t chanses[] = {5, 1, 1, 1, 1, 1};
+        for(int i = 0; i < 6; i++){
+            TileImage img;
+            img.getImage() = cv::Mat(tileSet.getTileSize(), CV_8UC4, cv::Scalar(i * 40, 255 - i * 40, 128, 255));
+            tileSet.addTile(Tile(img, TileSides(1, sides[i]), chanses[i]));
+        }
+    }
+}
+
+#ifndef WFC_ENABLE_PROFILING
+void* operator new(size_t size){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept{
+    std::free(ptr);
+}
+#endif
+
+int main(){
+    TileSet tileSet(1, {24, 24});
+    fillTileSet(tileSet);
+    tileSet.getAdjacency();
+
+    //tile access: metadata and image are read through references
+    {
+        const size_t tilesCount = tileSet.getAdjacency().getTilesCount();
+        const size_t calls = 10'000'000;
+        size_t checksum = 0;
+
+        const size_t before = allocationsCount();
+        const double start = nowSeconds();
+        for(size_t i = 0; i < calls; i++){
+            const Tile& tile = tileSet.getTileById(i % tilesCount);
+            checksum += tile.getSides()[i % 4].size() + tile.getImage().cols;
+        }
+        const double seconds = nowSeconds() - start;
+        const size_t allocated = allocationsCount() - before;
+
+        std::cout<<"tile access: "<<calls<<" calls, "<<seconds * 1e9 / calls<<" ns/call, "
+                 <<allocated<<" allocations (checksum "<<checksum<<")\n";
+    }
+
+    //generation and rendering: allocations of buffers don't depend on count of cells,
+    //so difference between two map sizes is allocations made by steps
+    TileMapGenerator generator;
+    generator.generateMap(tileSet, {16, 16}, 1);
+
+    const int sizes[] = {64, 128, 256};
+    size_t lastAllocated = 0, lastCells = 0;
+    for(int size: sizes){
+        const size_t before = allocationsCount();
+        const double start = nowSeconds();
+        generator.generateMap(tileSet, {size, size}, 1);
+        const double seconds = nowSeconds() - start;
+        const size_t allocated = allocationsCount() - before;
+        const size_t cells = static_cast<size_t>(size) * size;
+
+        std::cout<<"generateMap "<<size<<"x"<<size<<": "<<seconds * 1e9 / cells<<" ns/cell, "
+                 <<allocated<<" allocations";
+        if(lastCells != 0){
+            std::cout<<", "<<(static_cast<double>(allocated) - static_cast<double>(lastAllocated)) / (cells - lastCells)
+                     <<" allocations/step";
+        }
+        std::cout<<"\n";
+        lastAllocated = allocated;
+        lastCells = cells;
+    }
+    return 0;
+}
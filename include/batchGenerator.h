@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <opencv2/core.hpp>
+#include "wfcSolver.h"
+#include "tileGrid.h"
+#include "threadPool.h"
+
+class TileSet;
+
+struct BatchStats{
+    size_t maps = 0;
+    double seconds = 0;
+    double mapsPerSecond = 0;
+    WfcStats wfc; //sum of stats of all maps
+};
+
+//generates many maps of the same size concurrently
+//every worker owns solver and map, tile set is shared read-only
+class BatchGenerator{
+public:
+    //index - index of seed in list of seeds
+    //map is valid only during the call
+    using Callback = std::function<void(size_t index, uint64_t seed, const TileIdGrid& map, const WfcStats& stats)>;
+
+private:
+    TileSet& m_tileSet;
+    ThreadPool m_pool;
+    std::vector<std::unique_ptr<WfcSolver>> m_solvers; //solver of every worker
+    std::vector<TileIdGrid> m_maps;                    //map of every worker
+    size_t m_tilesCount;
+    std::mutex m_callbackMutex;
+
+public:
+    //threads - count of threads, 0 - count of hardware threads
+    BatchGenerator(TileSet& tileSet, size_t threads = 0, const WfcConfig& config = WfcConfig());
+
+    size_t getThreadsCount() const noexcept;
+    //generate map for every seed, callback is called as soon as map is ready
+    //calls of callback are serialized, but they come in order of finishing maps
+    BatchStats generate(cv::Size sizeMap, const std::vector<uint64_t>& seeds, const Callback& callback);
+};
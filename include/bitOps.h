@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+//bitsets of several hundred tiles are aligned to cache line, so vector loads don't cross it
+constexpr size_t BITSET_ALIGNMENT = 64;
+//count of uint64_t words in the widest vector register (512 bits)
+constexpr size_t BITSET_VECTOR_WORDS = BITSET_ALIGNMENT / sizeof(uint64_t);
+
+template<typename T>
+struct AlignedAllocator{
+    using value_type = T;
+
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept{}
+
+    T* allocate(size_t count){
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(BITSET_ALIGNMENT)));
+    }
+    void deallocate(T* ptr, size_t) noexcept{
+        ::operator delete(ptr, std::align_val_t(BITSET_ALIGNMENT));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U>&) const noexcept{ return true; }
+};
+
+using AlignedWords = std::vector<uint64_t, AlignedAllocator<uint64_t>>;
+
+//wide operations over bitsets of uint64_t words for propagation of big tile sets
+//there are scalar, AVX2 and AVX-512 implementations, the best one is chosen once by instruction sets of CPU
+//bitsets may be unaligned, their count of words doesn't have to be a multiple of vector
+struct BitOps{
+    //dst |= src
+    void (*orInto)(uint64_t* dst, const uint64_t* src, size_t words);
+    //removed = domain & ~allowed
+    //return ANY_LEFT if domain & allowed isn't empty, ANY_REMOVED if removed isn't empty
+    uint32_t (*subtract)(const uint64_t* domain, const uint64_t* allowed, uint64_t* removed, size_t words);
+    const char* name;
+
+    static constexpr uint32_t ANY_LEFT = 1;
+    static constexpr uint32_t ANY_REMOVED = 2;
+
+    //the fastest implementation which CPU supports
+    static const BitOps& best();
+    static const BitOps& scalar();
+    //all implementations which CPU supports from scalar to the fastest
+    static std::vector<const BitOps*> supported();
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+//set of cells with O(1) insertion, erasure and removal by index
+//every cell is in frontier at most once, so random removal never returns duplicates
+class CellFrontier{
+private:
+    static constexpr uint32_t NOT_IN_FRONTIER = UINT32_MAX;
+
+    std::vector<uint32_t> m_cells;     //cells in any order
+    std::vector<uint32_t> m_positions; //index of cell in m_cells or NOT_IN_FRONTIER
+
+public:
+    CellFrontier() = default;
+
+    //make frontier empty for cells [0, cellsCount)
+    void reset(size_t cellsCount){
+        m_cells.clear();
+        m_positions.assign(cellsCount, NOT_IN_FRONTIER);
+    }
+
+    bool empty() const noexcept{ return m_cells.empty(); }
+    size_t size() const noexcept{ return m_cells.size(); }
+    bool contains(uint32_t cell) const noexcept{ return m_positions[cell] != NOT_IN_FRONTIER; }
+
+    //return false if cell is already in frontier
+    bool insert(uint32_t cell){
+        if(contains(cell)) return false;
+        m_positions[cell] = static_cast<uint32_t>(m_cells.size());
+        m_cells.push_back(cell);
+        return true;
+    }
+
+    //remove cell at index, the last cell takes its place
+    uint32_t removeAt(size_t index) noexcept{
+        const uint32_t cell = m_cells[index];
+        const uint32_t last = m_cells.back();
+        m_cells[index] = last;
+        m_positions[last] = static_cast<uint32_t>(index);
+        m_cells.pop_back();
+        m_positions[cell] = NOT_IN_FRONTIER;
+        return cell;
+    }
+
+    void erase(uint32_t cell) noexcept{
+        if(contains(cell)) removeAt(m_positions[cell]);
+    }
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <opencv2/core.hpp>
+#include "wfcSolver.h"
+#include "tileGrid.h"
+#include "tileRenderer.h"
+
+class TileSet;
+
+//infinite world which is generated by square chunks on demand
+//chunk (cx, cy) covers cells [cx*chunkSize, (cx+1)*chunkSize) x [cy*chunkSize, (cy+1)*chunkSize)
+//top row and left column of every chunk are seams shared with upper and left chunks
+//seams depend only on world seed and their coordinates, so every chunk is the same
+//in any generation order and borders of neighbour chunks always fit each other
+class ChunkedWorld{
+private:
+    struct Chunk{
+        int64_t key;
+        TileIdGrid tiles;
+    };
+
+    TileSet& m_tileSet;
+    WfcSolver m_solver;
+    TileRenderer m_renderer;
+    uint64_t m_seed;
+    int m_chunkSize;
+    size_t m_maxChunks;
+    size_t m_tilesCount;
+
+    std::list<Chunk> m_chunks; //resident chunks, front is the last used
+    std::unordered_map<int64_t, std::list<Chunk>::iterator> m_chunksIndex;
+
+private:
+    static int64_t _chunkKey(int cx, int cy) noexcept;
+    //seed of generation for some part of the world
+    uint64_t _partSeed(uint32_t part, int cx, int cy) const noexcept;
+    //tile on the corner of chunk (cx, cy)
+    size_t _cornerTile(int cx, int cy);
+    //horizontal seam on top of chunk (cx, cy), chunkSize + 1 cells with corners
+    std::vector<size_t> _horizontalSeam(int cx, int cy);
+    //vertical seam on left of chunk (cx, cy), chunkSize + 1 cells with corners
+    std::vector<size_t> _verticalSeam(int cx, int cy);
+    TileIdGrid _generateChunk(int cx, int cy);
+
+public:
+    //seed - world seed
+    //chunkSize - width and height of chunk in tiles
+    //maxChunks - count of chunks which are kept in memory
+    ChunkedWorld(TileSet& tileSet, uint64_t seed, int chunkSize, size_t maxChunks, const WfcConfig& config = WfcConfig());
+
+    int getChunkSize() const noexcept;
+    //get chunk, it's generated if it isn't in memory
+    //reference is valid until next call of getChunk() or getCell()
+    const TileIdGrid& getChunk(int cx, int cy);
+    //get tile id + 1 of cell in world coordinates or 0 for empty cell
+    size_t getCell(int64_t x, int64_t y);
+    //render chunk's tiles to image
+    cv::Mat renderChunk(int cx, int cy);
+};
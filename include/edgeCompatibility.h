@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+//rules of matching sides of neighbour tiles
+//sides fit if they are equal or there is a rule which allows them
+//rules are directed: side first of left or upper tile fits side second of right or lower tile,
+//so road can end only on one side of road end, symmetric rule is two directed rules
+//WILDCARD in side of tile or in rule matches any feature, for example "1*" fits "10" and "11"
+//rules are compiled into TileAdjacency, so they don't change cost of generation
+class EdgeCompatibility{
+public:
+    static constexpr char WILDCARD = '*';
+
+private:
+    std::vector<std::pair<std::string, std::string>> m_rules; //directed rules (first, second)
+
+private:
+    //pattern and side have equal count of features and every feature is equal or wildcard
+    static bool _matches(const std::string& pattern, const std::string& side) noexcept;
+
+public:
+    EdgeCompatibility() = default;
+
+    //side a fits side b in any direction, sides can have wildcards
+    void allow(const std::string& a, const std::string& b);
+    //side first of left or upper tile fits side second of right or lower tile
+    void allowDirected(const std::string& first, const std::string& second);
+    //directed rules, allow() adds two rules for different sides
+    const std::vector<std::pair<std::string, std::string>>& getRules() const noexcept;
+    //there are no rules, only equal sides fit
+    bool empty() const noexcept;
+
+    //side a of left or upper tile fits side b of right or lower tile
+    bool isCompatible(const std::string& a, const std::string& b) const noexcept;
+    static bool hasWildcard(const std::string& side) noexcept;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <opencv2/core.hpp>
+
+enum class FrameFormat{
+    Images, //every frame is separated png image in directory
+    Video   //all frames are written to one video file
+};
+
+struct FrameOutput{
+    FrameFormat format = FrameFormat::Images;
+    std::string path;       //directory for images or file for video
+    double fps = 30;        //frame rate of video
+    size_t queueSize = 16;  //count of frames which wait for writing, generation waits if queue is full
+    size_t everySteps = 1;  //frame is written after every everySteps steps, cells left empty by contradictions are steps too
+};
+
+//writes frames on own thread, so encoding of frames doesn't block generation
+//frames are copied to buffers which are reused after writing
+class FrameWriter{
+private:
+    FrameOutput m_output;
+    std::thread m_thread;
+
+    std::mutex m_mutex;
+    std::condition_variable m_frameAdded;
+    std::condition_variable m_frameWritten;
+    std::deque<cv::Mat> m_frames; //frames waiting for writing in order of adding
+    std::vector<cv::Mat> m_free;  //buffers of written frames
+    size_t m_framesCount = 0;     //count of added frames
+    bool m_stop = false;
+    std::exception_ptr m_exception; //exception thrown by writing
+
+private:
+    void _writerLoop(cv::Size frameSize);
+
+public:
+    //frameSize - width and height of all frames in pixels
+    FrameWriter(const FrameOutput& output, cv::Size frameSize);
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    //copy frame to queue, it waits if queue is full
+    //after error of writing frames are dropped and the error is rethrown by finish()
+    void push(const cv::Mat& frame);
+    //write all frames from queue and stop writer, exception of writing is rethrown
+    void finish();
+    size_t getFramesCount() const noexcept;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+//binary min-heap of ids [0, capacity) with keys
+//every id is in heap at most once and its key is changed in place in O(log n),
+//so heap never holds outdated entries
+class IndexedHeap{
+private:
+    static constexpr uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+    std::vector<uint32_t> m_heap;      //ids in heap order
+    std::vector<double> m_keys;        //key of every id
+    std::vector<uint32_t> m_positions; //index of id in m_heap or NOT_IN_HEAP
+
+private:
+    void _place(size_t pos, uint32_t id) noexcept{
+        m_heap[pos] = id;
+        m_positions[id] = static_cast<uint32_t>(pos);
+    }
+
+    void _siftUp(size_t pos) noexcept{
+        const uint32_t id = m_heap[pos];
+        while(pos > 0){
+            const size_t parent = (pos - 1) / 2;
+            if(m_keys[m_heap[parent]] <= m_keys[id]) break;
+            _place(pos, m_heap[parent]);
+            pos = parent;
+        }
+        _place(pos, id);
+    }
+
+    void _siftDown(size_t pos) noexcept{
+        const uint32_t id = m_heap[pos];
+        const size_t size = m_heap.size();
+        while(true){
+            size_t child = pos * 2 + 1;
+            if(child >= size) break;
+            if(child + 1 < size && m_keys[m_heap[child + 1]] < m_keys[m_heap[child]]) child++;
+            if(m_keys[id] <= m_keys[m_heap[child]]) break;
+            _place(pos, m_heap[child]);
+            pos = child;
+        }
+        _place(pos, id);
+    }
+
+    void _removeAt(size_t pos) noexcept{
+        const uint32_t id = m_heap[pos];
+        const uint32_t last = m_heap.back();
+        m_heap.pop_back();
+        m_positions[id] = NOT_IN_HEAP;
+        if(pos == m_heap.size()) return;
+
+        m_heap[pos] = last;
+        m_positions[last] = static_cast<uint32_t>(pos);
+        if(pos > 0 && m_keys[last] < m_keys[m_heap[(pos - 1) / 2]]) _siftUp(pos);
+        else _siftDown(pos);
+    }
+
+public:
+    IndexedHeap() = default;
+
+    //make heap empty for ids [0, capacity)
+    void reset(size_t capacity){
+        m_heap.clear();
+        m_keys.assign(capacity, 0);
+        m_positions.assign(capacity, NOT_IN_HEAP);
+    }
+    //remove all ids, it takes time of count of ids in heap
+    void clear() noexcept{
+        for(uint32_t id: m_heap) m_positions[id] = NOT_IN_HEAP;
+        m_heap.clear();
+    }
+
+    bool empty() const noexcept{ return m_heap.empty(); }
+    size_t size() const noexcept{ return m_heap.size(); }
+    bool contains(uint32_t id) const noexcept{ return m_positions[id] != NOT_IN_HEAP; }
+
+    //insert id or change its key
+    void set(uint32_t id, double key){
+        if(!contains(id)){
+            m_keys[id] = key;
+            m_positions[id] = static_cast<uint32_t>(m_heap.size());
+            m_heap.push_back(id);
+            _siftUp(m_heap.size() - 1);
+            return;
+        }
+        const double oldKey = m_keys[id];
+        m_keys[id] = key;
+        if(key < oldKey) _siftUp(m_positions[id]);
+        else _siftDown(m_positions[id]);
+    }
+
+    void erase(uint32_t id) noexcept{
+        if(contains(id)) _removeAt(m_positions[id]);
+    }
+
+    //id with the lowest key, heap shouldn't be empty
+    uint32_t top() const noexcept{ return m_heap.front(); }
+    uint32_t pop() noexcept{
+        const uint32_t id = m_heap.front();
+        _removeAt(0);
+        return id;
+    }
+};
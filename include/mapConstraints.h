@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "tileAdjacency.h"
+#include "tileGrid.h"
+
+class TileSet;
+
+//constraints of map which are known before generation
+//every cell has mask of allowed tiles, by default all tiles are allowed
+//solvers restrict cells by masks and propagate them before the first random choice
+class MapConstraints{
+private:
+    const TileAdjacency& m_adjacency;
+    cv::Size m_size;
+    size_t m_words;
+    size_t m_tilesCount;
+    uint64_t m_tileSetHash; //TileSet::getHash() of tile set of constraints
+    std::vector<uint64_t> m_masks;     //[cell * m_words + word]
+    std::vector<uint8_t> m_restricted; //mask of cell was changed
+
+private:
+    uint64_t* _mask(int x, int y) noexcept{ return m_masks.data() + (static_cast<size_t>(y) * m_size.width + x) * m_words; }
+    void _checkCell(int x, int y) const;
+
+public:
+    //size - width and height of map in tiles
+    MapConstraints(TileSet& tileSet, cv::Size size);
+
+    cv::Size getSize() const noexcept;
+    size_t getWordsCount() const noexcept;
+    size_t getTilesCount() const noexcept;
+    uint64_t getTileSetHash() const noexcept;
+    //throw if constraints were built for other tile set or tiles were added to tile set after it
+    void checkTileSet(TileSet& tileSet) const;
+    //cell has other mask than all tiles
+    bool isRestricted(int x, int y) const noexcept{ return m_restricted[static_cast<size_t>(y) * m_size.width + x]; }
+    //allowed tiles of cell, bitset of getWordsCount() words
+    const uint64_t* getMask(int x, int y) const noexcept{
+        return m_masks.data() + (static_cast<size_t>(y) * m_size.width + x) * m_words;
+    }
+
+    //only this tile is allowed in cell
+    void pinTile(int x, int y, size_t tileId);
+    //pin every not empty cell of grid, cell is tile id + 1 or 0 for free cell
+    void pinTiles(const TileIdGrid& grid);
+    //keep allowed only tiles of bitset, it's intersected with previous constraints
+    void allowTiles(int x, int y, const uint64_t* allowed);
+    void allowTiles(cv::Rect region, const uint64_t* allowed);
+    //forbid tile in every cell of region
+    void forbidTile(cv::Rect region, size_t tileId);
+    //side of every tile on border of map in direction dir should fit side, side is side of tile or of rule
+    //dir - 0 top, 1 right, 2 bottom, 3 left border
+    void setBorderSide(uint32_t dir, const std::string& side);
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <bit>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <opencv2/core.hpp>
+#include "tileGrid.h"
+#include "mappedFile.h"
+
+//binary file of tile ids of map, it's much smaller than rendered image and it's read without rendering
+//layout (little endian):
+//  header
+//  chunks of rowsPerChunk rows, every chunk is byte of encoding and then list of runs of equal cells
+//  (varint count, varint value) or varint value of every cell, writer chooses the shorter one
+//  index: offset of every chunk and offset of end of the last chunk
+//values of cells are tile id + 1 or 0 for empty cell like in TileIdGrid
+struct MapFileHeader{
+    char magic[4];
+    uint32_t version;
+    uint64_t tileSetHash; //TileSet::getHash() of tile set of map
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesCount;
+    uint32_t rowsPerChunk;
+    uint32_t chunksCount;
+    uint32_t reserved;
+    uint64_t indexOffset;
+};
+static_assert(sizeof(MapFileHeader) == 48);
+//header and index are written as bytes of native integers, so they are little endian only on little endian machines
+static_assert(std::endian::native == std::endian::little, "map file is supported only on little endian machines");
+
+//writes map row by row, so full map doesn't need to be in memory
+class MapFileWriter{
+private:
+    std::ofstream m_file;
+    std::string m_path;
+    MapFileHeader m_header;
+    std::vector<uint64_t> m_offsets;  //offset of every written chunk
+    std::vector<uint32_t> m_chunk;    //cells of rows of current chunk
+    std::vector<uint8_t> m_encoded;   //encoded current chunk
+    std::vector<uint32_t> m_row;      //buffer for row of TileIdGrid
+    uint32_t m_rows = 0;              //count of written rows
+    bool m_finished = false;
+
+private:
+    void _writeChunk();
+
+public:
+    //size - width and height of map in cells
+    //tileSetHash, tilesCount - hash and count of tiles of tile set of map
+    //rowsPerChunk - count of rows which are encoded together, reader decodes whole chunks
+    MapFileWriter(const std::string& path, cv::Size size, uint64_t tileSetHash, size_t tilesCount, uint32_t rowsPerChunk = 64);
+    ~MapFileWriter();
+
+    MapFileWriter(const MapFileWriter&) = delete;
+    MapFileWriter& operator=(const MapFileWriter&) = delete;
+
+    //cells - next row of map, width values
+    void writeRow(const uint32_t* cells);
+    //write row y of grid as next row of map
+    void writeRow(const TileIdGrid& grid, int y);
+    //write all rows of grid, grid should have size of map
+    void writeMap(const TileIdGrid& grid);
+    //write index and header, all rows should be written
+    void finish();
+};
+
+//reads map file through memory mapping, only chunks which cover requested rows are decoded
+class MapFileReader{
+private:
+    MappedFile m_file;
+    MapFileHeader m_header;
+
+private:
+    uint64_t _chunkOffset(size_t chunk) const;
+    //decode chunk to cells, cells should have rowsPerChunk * width values
+    //return count of decoded rows
+    uint32_t _decodeChunk(size_t chunk, uint32_t* cells) const;
+
+public:
+    MapFileReader(const std::string& path);
+
+    cv::Size getSize() const noexcept;
+    uint64_t getTileSetHash() const noexcept;
+    size_t getTilesCount() const noexcept;
+
+    //read cells of rect, cells out of map are empty, negative size of rect throws
+    TileIdGrid read(cv::Rect rect) const;
+    //read whole map
+    TileIdGrid read() const;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+//memory mapping of whole file, POSIX only
+class MappedFile{
+private:
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+
+public:
+    MappedFile() = default;
+    //copyOnWrite - pages can be written, changes stay in memory and aren't written to file
+    MappedFile(const std::string& path, bool copyOnWrite = false);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const uint8_t* data() const noexcept{ return m_data; }
+    //writable data, only for mapping with copyOnWrite
+    uint8_t* data() noexcept{ return m_data; }
+    size_t size() const noexcept{ return m_size; }
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <opencv2/core.hpp>
+#include "tilesMap.h"
+
+struct OverlappingConfig{
+    int patternSize = 3;       //width and height of pattern in pixels
+    bool rotations = true;     //add patterns rotated by 90, 180 and 270 degrees
+    bool reflections = true;   //add mirrored patterns
+    bool periodicInput = true; //patterns wrap around borders of sample
+};
+
+//overlapping model of WFC: every NxN pattern of sample image is a tile
+//patterns fit each other if they are equal on the overlap shifted by one pixel,
+//so overlap of pattern is encoded as side: bottom side is hash of rows 1..N-1,
+//up side is hash of rows 0..N-2 and the same for columns, then equal sides mean equal overlaps
+//every tile is 1x1 pixel with color of top-left pixel of pattern, so map of tiles is output image
+class OverlappingModel{
+private:
+    static constexpr uint32_t SIDE_FEATURES = 16; //hex digits of 64 bit hash of overlap
+
+    OverlappingConfig m_config;
+    std::vector<uint32_t> m_patterns; //pixels of all patterns, patternSize^2 per pattern, BGRA packed to uint32
+    std::vector<uint32_t> m_counts;   //count of every pattern in sample
+
+private:
+    //add pattern or increase its count, it's found by hash
+    void _addPattern(const uint32_t* pixels, std::unordered_map<uint64_t, std::vector<uint32_t>>& index);
+    //hash of rect of pattern as SIDE_FEATURES hex digits
+    std::string _overlapSide(size_t pattern, int x, int y, int width, int height) const;
+
+public:
+    //sample - CV_8UC3 or CV_8UC4 image
+    OverlappingModel(const cv::Mat& sample, const OverlappingConfig& config = OverlappingConfig());
+
+    size_t getPatternsCount() const noexcept;
+    uint32_t getPatternCount(size_t pattern) const noexcept;
+    //pixels of pattern, patternSize^2 values
+    const uint32_t* getPattern(size_t pattern) const noexcept;
+
+    //tile set with tile for every pattern, chanse of tile is count of pattern
+    TileSet createTileSet() const;
+};
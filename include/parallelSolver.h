@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include "wfcSolver.h"
+#include "tileGrid.h"
+#include "threadPool.h"
+
+class TileSet;
+class MapConstraints;
+
+struct ParallelConfig{
+    size_t threads = 0;  //count of threads, 0 - count of hardware threads
+    int regionSize = 0;  //width and height of region solved by one task, 0 - chosen by map size and threads
+    int seamWidth = 3;   //cells on each side of region's border which are solved again
+    WfcConfig wfc;
+};
+
+//solves map on several threads
+//map is split into square regions which are solved independently, then seams on borders
+//of regions are solved again with fixed cells around them, seams are split into segments
+//between crossings of seams and crossings are solved last, so every task is small and
+//all borders fit each other in the end
+class ParallelSolver{
+private:
+    TileSet& m_tileSet;
+    ParallelConfig m_config;
+    ThreadPool m_pool;
+    std::vector<std::unique_ptr<WfcSolver>> m_solvers; //solver of every worker
+    size_t m_tilesCount;
+
+    std::mutex m_statsMutex;
+    WfcStats m_stats;
+
+private:
+    //solve cells of rect in map
+    //pinBorder - cells around rect are fixed and constrain it
+    void _solveRect(TileIdGrid& map, cv::Rect rect, bool pinBorder, uint64_t seed, const MapConstraints* constraints);
+
+public:
+    ParallelSolver(TileSet& tileSet, const ParallelConfig& config = ParallelConfig());
+
+    size_t getThreadsCount() const noexcept;
+    //solve map with size of sizeMap, map with zero width or height is left empty
+    //constraints - constraints of map with size of sizeMap for tile set of solver or nullptr
+    WfcStats solve(TileIdGrid& map, cv::Size sizeMap, uint64_t seed, const MapConstraints* constraints = nullptr);
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+//hot paths of generation which are timed by profiler
+enum class ProfileSection : uint32_t{
+    Frontier,       //choice of next cell
+    NeighbourSides, //gathering of neighbours' sides
+    Candidates,     //intersection of masks of suitable tiles
+    Choice,         //weighted choice of tile
+    Propagation,    //propagation of constraints in wave function collapse
+    Rendering,      //rendering of map to image
+    Count
+};
+
+constexpr size_t PROFILE_SECTIONS = static_cast<size_t>(ProfileSection::Count);
+
+struct SectionStats{
+    uint64_t calls = 0;
+    uint64_t nanoseconds = 0;
+};
+
+//statistics of one generation
+//counters are always collected, time of sections and allocations only with WFC_ENABLE_PROFILING
+struct GenerationStats{
+    size_t steps = 0;           //cells taken from frontier or collapsed
+    size_t contradictions = 0;  //cells where nothing fits
+    size_t peakFrontier = 0;    //the biggest count of cells in frontier or entropy heap
+    size_t allocations = 0;     //heap allocations while generation
+    std::array<SectionStats, PROFILE_SECTIONS> sections;
+};
+
+//collects time of sections from all threads and events for trace viewer
+//sections are recorded by WFC_PROFILE_SCOPE() which compiles to nothing without WFC_ENABLE_PROFILING
+class Profiler{
+private:
+    struct Event{
+        uint32_t section;
+        uint64_t start;    //nanoseconds from reset()
+        uint64_t duration; //nanoseconds
+    };
+    //every thread writes only own buffer, so recording doesn't lock
+    struct ThreadBuffer{
+        uint32_t thread;
+        std::array<SectionStats, PROFILE_SECTIONS> sections;
+        std::vector<Event> events;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::chrono::steady_clock::time_point m_origin;
+    size_t m_maxEvents = 1 << 20; //events per thread, later sections are only summed
+
+private:
+    Profiler();
+    ThreadBuffer& _threadBuffer();
+
+public:
+    static Profiler& instance();
+    static bool isEnabled() noexcept;
+    static const char* getSectionName(ProfileSection section) noexcept;
+    //count of heap allocations of process, it's counted only with WFC_ENABLE_PROFILING
+    static size_t getAllocationsCount() noexcept;
+
+    //forget all recorded sections, it shouldn't be called while other threads record them
+    void reset();
+    //maxEvents - events kept for trace per thread
+    void setMaxEvents(size_t maxEvents);
+
+    uint64_t now() const noexcept{
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_origin).count();
+    }
+    void record(ProfileSection section, uint64_t start, uint64_t end);
+    //sum of sections of all threads since reset()
+    std::array<SectionStats, PROFILE_SECTIONS> getSections() const;
+
+    //write events in trace event format of chrome://tracing and Perfetto, stats are added as metadata
+    void writeTrace(const std::string& path, const GenerationStats& stats) const;
+};
+
+//time of scope is recorded as section
+class ProfileScope{
+private:
+    ProfileSection m_section;
+    uint64_t m_start;
+
+public:
+    ProfileScope(ProfileSection section):m_section(section), m_start(Profiler::instance().now()){}
+    ~ProfileScope(){
+        Profiler& profiler = Profiler::instance();
+        profiler.record(m_section, m_start, profiler.now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#ifdef WFC_ENABLE_PROFILING
+    #define WFC_PROFILE_JOIN_IMPL(a, b) a##b
+    #define WFC_PROFILE_JOIN(a, b) WFC_PROFILE_JOIN_IMPL(a, b)
+    //time rest of scope as section, for example WFC_PROFILE_SCOPE(Propagation)
+    #define WFC_PROFILE_SCOPE(section) ProfileScope WFC_PROFILE_JOIN(profileScope, __LINE__)(ProfileSection::section)
+#else
+    #define WFC_PROFILE_SCOPE(section) ((void)0)
+#endif
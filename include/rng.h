@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+
+//mix bits of x, it's used for derive independent seeds from one seed
+inline uint64_t splitMix64(uint64_t x) noexcept{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+//seed of some part of generation, for example chunk or region, derived from main seed
+inline uint64_t deriveSeed(uint64_t seed, uint64_t a, uint64_t b = 0, uint64_t c = 0) noexcept{
+    uint64_t hash = splitMix64(seed ^ a);
+    hash = splitMix64(hash ^ b);
+    return splitMix64(hash ^ c);
+}
+
+//seedable pseudo random generator xoshiro256**
+//every generator owns its state, so generators on different threads don't share anything
+class Rng{
+private:
+    uint64_t m_state[4];
+
+    static uint64_t _rotl(uint64_t x, int k) noexcept{
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    using result_type = uint64_t;
+
+    explicit Rng(uint64_t seed = 0) noexcept{
+        setSeed(seed);
+    }
+
+    //same seed gives same sequence of numbers
+    void setSeed(uint64_t seed) noexcept{
+        for(int i = 0; i < 4; i++){
+            seed += 0x9e3779b97f4a7c15ULL;
+            m_state[i] = splitMix64(seed);
+        }
+    }
+
+    uint64_t next() noexcept{
+        const uint64_t result = _rotl(m_state[1] * 5, 7) * 9;
+        const uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = _rotl(m_state[3], 45);
+        return result;
+    }
+
+    //uniform number in [0, bound) without modulo bias, bound should be greater than 0
+    uint64_t nextBounded(uint64_t bound) noexcept{
+        //Lemire's multiply and reject method
+        unsigned __int128 m = static_cast<unsigned __int128>(next()) * bound;
+        uint64_t low = static_cast<uint64_t>(m);
+        if(low < bound){
+            const uint64_t threshold = -bound % bound;
+            while(low < threshold){
+                m = static_cast<unsigned __int128>(next()) * bound;
+                low = static_cast<uint64_t>(m);
+            }
+        }
+        return static_cast<uint64_t>(m >> 64);
+    }
+
+    //uniform number in [0, 1)
+    double nextDouble() noexcept{
+        return (next() >> 11) * 0x1.0p-53;
+    }
+
+    //for using as UniformRandomBitGenerator
+    static constexpr uint64_t min() noexcept{ return 0; }
+    static constexpr uint64_t max() noexcept{ return UINT64_MAX; }
+    uint64_t operator()() noexcept{ return next(); }
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+
+//pool of worker threads with own task queue per worker
+//worker takes the newest task from own queue and steals the oldest task from other queues
+class ThreadPool{
+private:
+    struct WorkerQueue{
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskAdded;
+    std::condition_variable m_tasksDone;
+    std::atomic<size_t> m_queued = 0;     //count of tasks in queues
+    std::atomic<size_t> m_unfinished = 0; //count of submitted and not finished tasks
+    std::atomic<size_t> m_nextQueue = 0;  //queue for task submitted outside of workers
+    bool m_stop = false;
+    std::exception_ptr m_exception; //first exception thrown by task
+
+private:
+    void _workerLoop(size_t index);
+    bool _popTask(size_t index, std::function<void()>& task);
+
+public:
+    static constexpr size_t NOT_WORKER = SIZE_MAX;
+
+    //threads - count of worker threads, 0 - count of hardware threads
+    ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getThreadsCount() const noexcept;
+    //index of worker which calls this function or NOT_WORKER
+    static size_t currentWorker() noexcept;
+
+    void submit(std::function<void()> task);
+    //wait until all submitted tasks are done, rethrow first exception of tasks
+    void wait();
+    //call func(i) for every i in [0, count) and wait
+    void parallelFor(size_t count, const std::function<void(size_t)>& func);
+};
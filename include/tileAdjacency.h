@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <bit>
+#include "edgeCompatibility.h"
+
+//compiled side index of a tile set
+//every side string is interned to an integer id and for every (direction, side id)
+//stores bitset of tiles which can stand next to a neighbour with this facing side
+//sides are matched by EdgeCompatibility while index is built
+class TileAdjacency{
+public:
+    static constexpr uint32_t NO_SIDE = UINT32_MAX;          //there is no neighbour, every tile fits
+    static constexpr uint32_t UNKNOWN_SIDE = UINT32_MAX - 1; //side isn't used by any tile or rule, nothing fits
+
+private:
+    std::unordered_map<std::string, uint32_t> m_sideIds;
+    std::vector<std::string> m_sideNames;
+    std::vector<std::array<uint32_t, 4>> m_tileSides; //side ids of every tile, [0]-up, [1]-right, [2]-bottom, [3]-left
+    std::array<std::vector<uint64_t>, 4> m_masks; //[direction][sideId * m_words + word]
+    std::vector<uint64_t> m_allTiles; //mask with all tiles
+    size_t m_words = 0; //count of uint64_t words in one mask
+    size_t m_tilesCount = 0;
+
+public:
+    TileAdjacency() = default;
+
+    //tileSides - sides of every tile of tile set in the order of tile ids
+    //compatibility - rules of matching sides
+    void build(const std::vector<std::array<std::string, 4>>& tileSides, const EdgeCompatibility& compatibility = EdgeCompatibility());
+    //restore index which was built before
+    //sideNames - interned sides in the order of side ids
+    //tileSides - side ids of every tile
+    //masks - 4 * sideNames.size() masks in the layout of getMask()
+    void load(std::vector<std::string> sideNames, std::vector<std::array<uint32_t, 4>> tileSides, const uint64_t* masks);
+
+    size_t getTilesCount() const noexcept;
+    size_t getWordsCount() const noexcept;
+    size_t getSidesCount() const noexcept;
+
+    //return interned id of side or UNKNOWN_SIDE, "" is NO_SIDE
+    //sides of tiles and sides of rules of compatibility are interned
+    uint32_t getSideId(const std::string& side) const;
+    const std::string& getSideName(uint32_t sideId) const;
+    //id of tile's side in direction dir
+    uint32_t getTileSide(size_t tileId, uint32_t dir) const noexcept{
+        return m_tileSides[tileId][dir];
+    }
+
+    //tiles which side in direction dir fits to neighbour's side sideId
+    const uint64_t* getMask(uint32_t dir, uint32_t sideId) const noexcept{
+        return m_masks[dir].data() + sideId * m_words;
+    }
+    const uint64_t* getAllTilesMask() const noexcept;
+
+    //neighbourSides - ids of neighbour's sides which look at the tile, [0] is bottom side of upper neighbour and so on
+    //result - buffer of getWordsCount() words for bitset of suitable tiles
+    //return true if there is at least one suitable tile
+    bool getCandidates(const std::array<uint32_t, 4>& neighbourSides, uint64_t* result) const noexcept;
+
+    static bool testBit(const uint64_t* mask, size_t id) noexcept{
+        return (mask[id >> 6] >> (id & 63)) & 1;
+    }
+    static size_t countBits(const uint64_t* mask, size_t words) noexcept{
+        size_t count = 0;
+        for(size_t i = 0; i<words; i++) count += std::popcount(mask[i]);
+        return count;
+    }
+    //call func(id) for every set bit in ascending order
+    template<typename Func>
+    static void forEachBit(const uint64_t* mask, size_t words, Func&& func){
+        for(size_t i = 0; i<words; i++){
+            uint64_t word = mask[i];
+            while(word){
+                func((i << 6) + std::countr_zero(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <opencv2/core.hpp>
+
+//flat row-major grid
+template<typename T>
+class Grid{
+private:
+    std::vector<T> m_data;
+    cv::Size m_size;
+
+public:
+    Grid() = default;
+    Grid(cv::Size size, const T& value = T()):m_data(size.area(), value), m_size(size){}
+
+    cv::Size getSize() const noexcept{ return m_size; }
+
+    T& at(int x, int y) noexcept{ return m_data[static_cast<size_t>(y) * m_size.width + x]; }
+    const T& at(int x, int y) const noexcept{ return m_data[static_cast<size_t>(y) * m_size.width + x]; }
+
+    T* row(int y) noexcept{ return m_data.data() + static_cast<size_t>(y) * m_size.width; }
+    const T* row(int y) const noexcept{ return m_data.data() + static_cast<size_t>(y) * m_size.width; }
+
+    T* data() noexcept{ return m_data.data(); }
+    const T* data() const noexcept{ return m_data.data(); }
+
+    void fill(const T& value){ std::fill(m_data.begin(), m_data.end(), value); }
+};
+
+//flat row-major grid of tile ids, every cell stores tile id + 1 or 0 for empty cell
+//cell takes 1, 2 or 4 bytes depending on count of tiles in tile set
+class TileIdGrid{
+private:
+    std::vector<uint8_t> m_data;
+    cv::Size m_size;
+    uint32_t m_bytes = 1; //bytes per cell
+
+public:
+    TileIdGrid() = default;
+    //tilesCount - count of tiles in tile set, cells can store values [0, tilesCount]
+    TileIdGrid(cv::Size size, size_t tilesCount)
+              :m_size(size), m_bytes(bytesForTiles(tilesCount)){
+        m_data.assign(static_cast<size_t>(size.area()) * m_bytes, 0);
+    }
+
+    //count of bytes needed for cell of tile set with tilesCount tiles
+    static uint32_t bytesForTiles(size_t tilesCount) noexcept{
+        if(tilesCount <= UINT8_MAX) return 1;
+        if(tilesCount <= UINT16_MAX) return 2;
+        return 4;
+    }
+
+    cv::Size getSize() const noexcept{ return m_size; }
+    uint32_t getBytesPerCell() const noexcept{ return m_bytes; }
+
+    //return tile id + 1 or 0 for empty cell
+    size_t get(int x, int y) const noexcept{
+        const size_t i = (static_cast<size_t>(y) * m_size.width + x) * m_bytes;
+        switch(m_bytes){
+        case 1:
+            return m_data[i];
+        case 2:{
+            uint16_t value;
+            std::memcpy(&value, m_data.data() + i, sizeof(value));
+            return value;
+        }
+        default:{
+            uint32_t value;
+            std::memcpy(&value, m_data.data() + i, sizeof(value));
+            return value;
+        }
+        }
+    }
+
+    //value - tile id + 1 or 0 for empty cell
+    void set(int x, int y, size_t value) noexcept{
+        const size_t i = (static_cast<size_t>(y) * m_size.width + x) * m_bytes;
+        switch(m_bytes){
+        case 1:
+            m_data[i] = static_cast<uint8_t>(value);
+            break;
+        case 2:{
+            const uint16_t tmp = static_cast<uint16_t>(value);
+            std::memcpy(m_data.data() + i, &tmp, sizeof(tmp));
+            break;
+        }
+        default:{
+            const uint32_t tmp = static_cast<uint32_t>(value);
+            std::memcpy(m_data.data() + i, &tmp, sizeof(tmp));
+            break;
+        }
+        }
+    }
+
+    //raw row-major cells, getBytesPerCell() bytes per cell in native byte order
+    const uint8_t* data() const noexcept{ return m_data.data(); }
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <opencv2/core.hpp>
+#include "tileGrid.h"
+#include "threadPool.h"
+
+class TileRenderer;
+class MapFileReader;
+
+struct PyramidOutput{
+    std::string path;               //directory of images z/x/y.<format>
+    int tileSize = 1024;            //width and height of image tile in pixels
+    std::string format = "png";     //png or webp
+    bool mipmaps = true;            //write downsampled zooms down to zoom 0, otherwise only full resolution
+    bool viewer = true;             //write index.html which shows images in slippy map
+    size_t threads = 0;             //count of threads encoding images, 0 - count of hardware threads
+};
+
+struct PyramidInfo{
+    int minZoom = 0;
+    int maxZoom = 0;            //zoom of full resolution
+    cv::Size imageSize;         //size of map image in pixels on maxZoom
+    size_t imagesCount = 0;     //count of written image tiles
+};
+
+//writes rendered map as pyramid of image tiles for slippy map viewers, image tile (x, y) of zoom z
+//is file path/z/x/y.<format>, maxZoom has full resolution, every lower zoom is downsampled twice
+//and zoom 0 is one image tile, image tiles out of map are transparent
+//map is rendered by bands of cells which cover one row of image tiles, downsampled rows are collected
+//in one band per zoom, so memory is bounded by one row of image tiles and whole map image is never created
+class TilePyramidWriter{
+public:
+    //return cells of rect of map, cells out of map are empty
+    using CellsReader = std::function<TileIdGrid(cv::Rect)>;
+
+private:
+    struct Zoom{
+        int columns;  //count of image tiles in row
+        int rows;     //count of rows of image tiles
+        cv::Mat band; //row of image tiles which is filled by downsampled images of upper zoom
+    };
+
+    TileRenderer& m_renderer;
+    PyramidOutput m_output;
+    ThreadPool m_pool;
+    std::vector<Zoom> m_zooms; //[zoom - minZoom]
+    PyramidInfo m_info;
+
+private:
+    //write image tiles of row y of zoom from band and downsample them to band of lower zoom
+    void _writeRow(int zoom, int y, const cv::Mat& band, int bandY);
+    void _writeViewer() const;
+
+public:
+    //renderer - built renderer of tile set of map
+    TilePyramidWriter(TileRenderer& renderer, const PyramidOutput& output);
+
+    //mapSize - size of map in cells
+    PyramidInfo write(cv::Size mapSize, const CellsReader& readCells);
+    PyramidInfo write(const TileIdGrid& map);
+    //only rows of map which cover current row of image tiles are decoded
+    PyramidInfo write(const MapFileReader& reader);
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <opencv2/core.hpp>
+#include "tileGrid.h"
+#include "threadPool.h"
+
+class TileSet;
+
+//renders maps of tile ids to images
+//images of all tiles are packed into one contiguous atlas, tile after tile and row after row,
+//so every row of tile is copied to map image by one memcpy
+class TileRenderer{
+private:
+    std::vector<uint8_t> m_atlas;
+    cv::Size m_tileSize;
+    int m_type = 0;          //type of tile images
+    size_t m_rowBytes = 0;   //bytes in one row of tile
+    size_t m_tileBytes = 0;  //bytes in whole tile
+    size_t m_tilesCount = 0;
+
+    size_t m_threads;
+    std::unique_ptr<ThreadPool> m_pool; //created on first render which is worth of threads
+
+private:
+    //render cells [x0, x1) of row y
+    void _renderRow(const TileIdGrid& map, cv::Mat& image, int y, int x0, int x1) const;
+
+public:
+    //threads - count of threads for rendering of whole map, 0 - count of hardware threads
+    TileRenderer(size_t threads = 0);
+
+    //pack images of all tiles to atlas, it should be called again after adding tiles to tile set
+    void build(const TileSet& tileSet, size_t tilesCount);
+
+    size_t getTilesCount() const noexcept;
+    cv::Size getTileSize() const noexcept;
+    //type of rendered images
+    int getType() const noexcept;
+
+    //render whole map, image is created if it doesn't fit the map
+    //rows of cells are split into bands which are rendered in parallel
+    void render(const TileIdGrid& map, cv::Mat& image);
+    //render only cells of rect on thread of caller, image should be already created
+    void renderCells(const TileIdGrid& map, cv::Mat& image, cv::Rect cells) const;
+};
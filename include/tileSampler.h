@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "rng.h"
+
+//weighted random choice of tiles by their chanse
+//weights are kept in contiguous array, so sampling never touches Tile objects
+class TileSampler{
+private:
+    std::vector<uint32_t> m_weights; //chanse of every tile
+    uint64_t m_totalWeight = 0;
+    //alias table over all tiles with non zero chanse
+    std::vector<double> m_aliasProbability;
+    std::vector<uint32_t> m_alias;
+
+public:
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+    TileSampler() = default;
+
+    //weights - chanse of every tile in the order of tile ids
+    void build(std::vector<uint32_t> weights);
+
+    size_t getTilesCount() const noexcept;
+    uint32_t getWeight(size_t id) const noexcept{ return m_weights[id]; }
+    const uint32_t* getWeights() const noexcept;
+
+    //choose tile from all tiles in O(1)
+    size_t sample(Rng& rng) const;
+    //choose tile from bitset of words words, return NOT_FOUND if bitset is empty
+    //if all tiles in bitset have zero chanse they are equiprobable
+    //it takes O(1) while bitset keeps most of the weight of all tiles,
+    //otherwise O(k + words) for k tiles in bitset
+    size_t sample(const uint64_t* mask, size_t words, Rng& rng) const;
+    //choose tile from list of ids, return NOT_FOUND if list is empty
+    //it takes O(count), weights of ids are summed once and tile is found by binary search
+    size_t sampleIds(const size_t* ids, size_t count, Rng& rng) const;
+};
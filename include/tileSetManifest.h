@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <opencv2/core.hpp>
+#include "tilesMap.h"
+
+//text description of tile set, one directive per line, '#' starts comment:
+//  features <count>                  count of features on every side
+//  tile_size <width> <height>        size of all tiles in pixels
+//  tile <image> <sides> [options]    sides - features of up, right, bottom and left sides together
+//  compatible <side> <side>          sides fit each other, '*' matches any feature, see EdgeCompatibility
+//  connects <side> <side>            first side of left or upper tile fits second side of right or lower tile
+//options of tile:
+//  weight=<n>           chanse for choose the tile, 1 by default
+//  background=<image>   image is drawn over background image
+//  symmetry=<class>     X, I, \, L, T, F, rotations or none, see TileSymmetry, rotations by default
+//paths of images are relative to directory of manifest
+class TileSetManifest{
+public:
+    struct TileEntry{
+        std::filesystem::path image;
+        std::filesystem::path background; //empty if tile hasn't background
+        std::string sides;
+        uint32_t weight = 1;
+        TileSymmetry symmetry = TileSymmetry::Rotations;
+        size_t line = 0; //line in manifest for error messages
+    };
+
+private:
+    std::string m_path;
+    uint32_t m_features = 0;
+    cv::Size m_tileSize;
+    std::vector<TileEntry> m_tiles;
+    EdgeCompatibility m_compatibility;
+
+private:
+    void _parseLine(const std::string& line, size_t lineNumber, const std::filesystem::path& directory);
+    [[noreturn]] void _error(size_t lineNumber, const std::string& message) const;
+
+public:
+    //read and check manifest, images aren't loaded
+    TileSetManifest(const std::string& path);
+
+    uint32_t getFeaturesCount() const noexcept;
+    cv::Size getTileSize() const noexcept;
+    const std::vector<TileEntry>& getTiles() const noexcept;
+    const EdgeCompatibility& getCompatibility() const noexcept;
+
+    //load images on threads threads, 0 - count of hardware threads
+    //tiles are added in the order of manifest, so ids of tiles don't depend on count of threads
+    TileSet createTileSet(size_t threads = 0) const;
+};
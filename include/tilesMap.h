@@ -5,22 +5,57 @@
 #include <array>
 #include <vector>
 #include <numeric>
+#include <memory>
+#include <unordered_map>
 #include <opencv2/opencv.hpp>
 #include <opencv2/core.hpp>
+#include "tileAdjacency.h"
+#include "edgeCompatibility.h"
+#include "tileSampler.h"
+#include "wfcSolver.h"
+#include "tileGrid.h"
+#include "parallelSolver.h"
+#include "tileRenderer.h"
+#include "frameWriter.h"
+#include "mappedFile.h"
+#include "mapConstraints.h"
+#include "profiler.h"
+#include "cellFrontier.h"
+
+//which rotated and mirrored variants of tile are different, like in the original WFC
+enum class TileSymmetry{
+    X,         //the same after any rotation and mirroring, 1 variant
+    I,         //symmetric by vertical and horizontal axes, 2 variants
+    Backslash, //symmetric by diagonal, 2 variants
+    L,         //4 rotations
+    T,         //4 rotations
+    F,         //4 rotations of tile and of its mirror
+    Rotations, //4 rotations, equal variants are found by sides and pixels
+    None       //only tile itself
+};
 
 class TileImage{
 private:
     cv::Mat m_img;
+    std::shared_ptr<const MappedFile> m_mapping; //mapping of cache file which image points to, or nullptr
 
 public:
     TileImage() = default;
     TileImage(const std::string& path);
     TileImage(const std::string& path, cv::Mat background);
+    //image is view of pixels in mapping, mapping stays open while this image or its copies exist
+    TileImage(cv::Mat img, std::shared_ptr<const MappedFile> mapping);
 
     //rotate clockwise sides by 90 degrees n times
     void rotate90Deg(uint32_t n);
+    //new image of variant, image isn't copied and keeps mapping for transform 0
+    //transform - 0-3 rotation clockwise by 90 degrees transform times, 4-7 mirror and then rotation
+    TileImage getTransformed(uint32_t transform) const;
 
+    //image of tile loaded from cache is view of mapping, so cv::Mat taken from it must not outlive this TileImage
+    //and its copies, use clone() to keep pixels longer
     cv::Mat& getImage();
+    const cv::Mat& getImage() const;
 };
 
 class TileSides{
@@ -42,9 +77,11 @@ public:
 
     //rotate clockwise sides by 90 degrees n times
     void rotate90Deg(uint32_t n);
+    //mirror by vertical axis, left and right sides are swapped
+    void mirror();
 
     uint32_t getCountFeatures() const noexcept;
-    std::array<std::string, 4> getSides() const noexcept;
+    const std::array<std::string, 4>& getSides() const noexcept;
 
     bool operator==(const TileSides& right) const noexcept;
     bool operator!=(const TileSides& right) const noexcept;
@@ -63,12 +100,15 @@ public:
     void rotate90Deg(uint32_t n);
     //dst - where the copy will be moved
     void createCopy(Tile& dst);
+    //variant of tile, see TileImage::getTransformed()
+    Tile getTransformed(uint32_t transform) const;
 
     uint32_t getCountFeatures() const noexcept;
     uint32_t getChanse() const noexcept;
 
-    decltype(std::declval<TileImage>().getImage()) getImage();
-    decltype(std::declval<TileSides>().getSides()) getSides() const;
+    decltype(std::declval<TileImage&>().getImage()) getImage();
+    decltype(std::declval<const TileImage&>().getImage()) getImage() const;
+    decltype(std::declval<const TileSides&>().getSides()) getSides() const;
 
     bool operator==(Tile& right) noexcept;
     bool operator!=(Tile& right) noexcept;
@@ -77,13 +117,22 @@ public:
 class TileSet{
 private:
     std::vector<Tile> m_tiles;
-    std::array<std::map<std::string, std::vector<size_t>>, 4> m_tileSides;
+    TileAdjacency m_tileSides; //compiled index of tiles by their sides
+    EdgeCompatibility m_compatibility; //rules of matching sides, compiled into m_tileSides
+    TileSampler m_sampler;     //weighted choice of tiles by chanse
     bool m_sorted = 0;
     uint32_t m_features; //count features
     cv::Size m_tileSize; //width and height of all tiles
+    std::shared_ptr<MappedFile> m_cache; //mapping of cache file, images of loaded tiles point to it
+    std::unordered_map<uint64_t, std::vector<cv::Mat>> m_images; //unique images by hash of pixels, tiles share them
+    mutable uint64_t m_hash = 0; //hash of tile set, it's computed again after tiles or rules are changed
+    mutable bool m_hashReady = false;
 
 private:
-    std::vector<Tile> _generateTiles(Tile& tile);
+    //variants of tile by symmetry without duplicates
+    std::vector<Tile> _generateTiles(Tile& tile, TileSymmetry symmetry);
+    //replace image of tile by the equal image which is already in tile set
+    void _shareImage(Tile& tile);
     std::vector<size_t> _getTilesIdBySides(const std::string sides[4]);
     std::vector<Tile> _getTilesBySides(const std::string sides[4]);
     void _sortTileSides();
@@ -91,47 +140,117 @@ private:
 public:
     TileSet(uint32_t countFeatures, cv::Size tileSize);
     //add tile to tileset
-    void addTile(Tile tile);
+    //symmetry - which rotated and mirrored variants of tile are added too
+    //variants with equal sides and pixels are added once, equal images are stored once
+    void addTile(Tile tile, TileSymmetry symmetry = TileSymmetry::Rotations);
 
     cv::Size getTileSize() const;
+    //set rules of matching sides, index of sides is rebuilt
+    void setCompatibility(EdgeCompatibility compatibility);
+    const EdgeCompatibility& getCompatibility() const noexcept;
+    //hash of tiles in the order of their ids with their sides, chanses and images and rules of sides
+    //tile ids saved with one tile set are valid for other tile set only if hashes are equal
+    //it's computed once after tiles or rules are changed
+    uint64_t getHash() const;
     //get vector of suitable tiles by it sides
     std::vector<Tile> getTilesBySides(const std::string& up, const std::string& right, const std::string& bottom, const std::string& left);
     //get vector of suitable tiles by it sides
     std::vector<Tile> getTilesBySides(const std::string sides[4]);
     //get vector of suitable tiles's id by it sides
     std::vector<size_t> getTilesIdBySides(const std::string sides[4]);
-    Tile getTileById(size_t id) const;
+    //get compiled index of tiles by sides, it's built once after adding tiles
+    const TileAdjacency& getAdjacency();
+    //get weighted sampler of tiles, it's built together with adjacency
+    const TileSampler& getSampler();
+    //tile stays valid until tiles are added to tile set, copy of tile keeps its image valid after
+    //tile set is destroyed, even if image is view of cache mapping
+    const Tile& getTileById(size_t id) const;
     //saves tiles as images in directory
     void saveCurrentTileSet(const std::string& directory);
+
+    //save all rotated tiles with their images and compiled index of sides to one file
+    void saveCache(const std::string& path);
+    //load tile set saved by saveCache(), images aren't copied and they are read from mapping of file
+    //every tile image holds the mapping, so it's closed when the last of them is destroyed
+    static TileSet loadCache(const std::string& path);
 };
 
 class TileMapGenerator{
 private:
-    cv::Mat m_mapImage;
-    std::vector<std::vector<size_t>> m_tileMap;
-    std::vector<std::vector<int>> m_visitedMap; //for disable infinity loop in generateMap()
+    cv::Mat m_mapImage; //rendered by getMap(), so generation of big maps doesn't need memory for image
+    bool m_imageReady = false; //m_mapImage shows m_tileMap
+    TileIdGrid m_tileMap; //tile id + 1 of every cell, 0 - empty cell
+    Grid<uint8_t> m_visitedMap; //for disable infinity loop in generateMap()
     cv::Size m_mapSize;
     cv::Size m_tileSize;
 
-    std::vector<std::pair<uint32_t, uint32_t>> m_insertTilePlaces; //queue for inserting tile on the map
+    CellFrontier m_frontier; //not visited cells next to visited cells, cell is y * width + x
+    std::vector<uint64_t> m_candidates; //bitset of suitable tiles for current step
+    Rng m_rng;
+    TileRenderer m_renderer;
+    uint64_t m_rendererHash = 0; //hash of tile set packed to atlas of m_renderer
+    bool m_rendererReady = false;
+    std::vector<std::pair<uint32_t, uint32_t>> m_dirtyCells; //cells changed since last frame
+    bool m_trackDirty = false; //fill m_dirtyCells, it's enabled only while steps are saved
+    const MapConstraints* m_constraints = nullptr; //constraints of current generation or nullptr
+    GenerationStats m_stats; //statistics of last generation
+    std::array<SectionStats, PROFILE_SECTIONS> m_sectionsStart; //time of profiler's sections before generation
+    size_t m_allocationsStart = 0;
 
 private:
     bool _isValidMapCoords(const std::pair<uint32_t, uint32_t>& coord) const;
-    std::array<std::string, 4> _getNeighbourSides(const TileSet& tileSet, std::pair<uint32_t, uint32_t> tileCoords) const;
-    void _generateImage(TileSet& tileSet);
+    //return side ids of neighbours which look at the tile or TileAdjacency::NO_SIDE
+    std::array<uint32_t, 4> _getNeighbourSides(const TileAdjacency& adjacency, std::pair<uint32_t, uint32_t> tileCoords) const;
+    //repaint only cells changed since last frame
+    void _renderDirtyCells();
     //return true if can do next step or false if can't do next step
-    uint32_t _doGenerateStep(TileSet& tileSet);
-    //rewrite or create new maps
-    void _initMaps();
+    bool _doGenerateStep(TileSet& tileSet);
+    //put not visited neighbours of cell to frontier
+    void _pushNeighbours(uint32_t x, uint32_t y);
+    //rewrite or create new maps of tile ids, tiles are packed to atlas of renderer only if tile set
+    //differs from tile set of previous generation by hash or count of tiles
+    void _initMaps(TileSet& tileSet);
+    //fill pinned cells of m_constraints and put their neighbours to the queue
+    //or put random cell to the queue if there are no pinned cells
+    void _initQueue();
+    //start and finish collecting of m_stats
+    void _startStats();
+    void _finishStats();
+    //constraints - constraints of map or nullptr
+    GenerationStats _generateMap(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const MapConstraints* constraints);
+    WfcStats _generateMapWfc(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const WfcConfig& config, const MapConstraints* constraints);
+    WfcStats _generateMapParallel(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const ParallelConfig& config, const MapConstraints* constraints);
 
 public:
     TileMapGenerator()=default;
 
     //sizeMap - map's size where width and height means count tiles by x and y coords
-    void generateMap(TileSet& tileSet, cv::Size sizeMap);
+    //seed - same seed and tile set give the same map
+    GenerationStats generateMap(TileSet& tileSet, cv::Size sizeMap, uint64_t seed = 0);
+    //generate map with tiles pinned and restricted by constraints, size of map is size of constraints
+    //greedy generation doesn't propagate constraints, so it only chooses tiles allowed in cell
+    GenerationStats generateMap(TileSet& tileSet, const MapConstraints& constraints, uint64_t seed = 0);
+    //generate map by wave function collapse, cells are collapsed in order of the lowest entropy
+    //and constraints are propagated after every collapse
+    //config - backtracking and restart policy for contradictions
+    WfcStats generateMapWfc(TileSet& tileSet, cv::Size sizeMap, uint64_t seed = 0, const WfcConfig& config = WfcConfig());
+    //constraints are propagated to all cells before the first collapse
+    WfcStats generateMapWfc(TileSet& tileSet, const MapConstraints& constraints, uint64_t seed = 0, const WfcConfig& config = WfcConfig());
+    //generate map by wave function collapse on several threads
+    //config - count of threads, size of regions solved independently and width of their seams
+    WfcStats generateMapParallel(TileSet& tileSet, cv::Size sizeMap, uint64_t seed = 0, const ParallelConfig& config = ParallelConfig());
+    WfcStats generateMapParallel(TileSet& tileSet, const MapConstraints& constraints, uint64_t seed = 0, const ParallelConfig& config = ParallelConfig());
     //generate map and save every generated tile on map to saveDirectory as separated image
-    void generateMap_saveSteps(TileSet& tileSet, cv::Size sizeMap, const std::string& saveDirectory);
+    void generateMap_saveSteps(TileSet& tileSet, cv::Size sizeMap, const std::string& saveDirectory, uint64_t seed = 0);
+    //generate map and write frames of generation to images or video
+    //frames are written on separated thread and only changed cells are repainted between frames
+    void generateMap_saveSteps(TileSet& tileSet, cv::Size sizeMap, const FrameOutput& output, uint64_t seed = 0);
 
-    //get last generated map
+    //get image of last generated map, it's rendered on first call after generation
+    //big maps should be written by TilePyramidWriter from getTileMap() instead
     cv::Mat getMap();
+    //get tile ids of last generated map, cell is tile id + 1 or 0 for empty cell
+    const TileIdGrid& getTileMap() const;
+    //get statistics of last generation in any mode, steps of wave function collapse are collapses
+    const GenerationStats& getStats() const;
 };
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "tileAdjacency.h"
+#include "rng.h"
+#include "tileSampler.h"
+#include "indexedHeap.h"
+#include "bitOps.h"
+
+class TileSet;
+class MapConstraints;
+
+//what solver does when backtracking can't resolve contradiction
+enum class RestartPolicy{
+    FullRestart, //reset the whole map to initial domains
+    LocalRegion  //reset only region around contradiction and solve it again
+};
+
+struct WfcConfig{
+    size_t maxBacktracks = 64;   //backtracks per contradiction before restart, 0 - don't backtrack
+    size_t maxRestarts = 64;     //restarts per run, after them contradictions stay as empty cells
+    RestartPolicy restartPolicy = RestartPolicy::LocalRegion;
+    uint32_t regionRadius = 4;   //radius of first local region, it's doubled on every next restart
+    bool simd = true;            //use AVX2/AVX-512 of CPU for tile sets with more than 256 tiles
+};
+
+struct WfcStats{
+    size_t collapses = 0;      //count of cells collapsed by random choice
+    size_t contradictions = 0; //count of cells whose domain became empty
+    size_t backtracks = 0;     //count of reverted decisions
+    size_t restarts = 0;       //count of full restarts
+    size_t localResolves = 0;  //count of local region re-solves
+    size_t holes = 0;          //count of cells left empty because nothing fits
+    size_t peakFrontier = 0;   //the biggest count of undecided cells in entropy heap
+
+    WfcStats& operator+=(const WfcStats& right) noexcept{
+        collapses += right.collapses;
+        contradictions += right.contradictions;
+        backtracks += right.backtracks;
+        restarts += right.restarts;
+        localResolves += right.localResolves;
+        holes += right.holes;
+        peakFrontier = std::max(peakFrontier, right.peakFrontier);
+        return *this;
+    }
+};
+
+//wave function collapse solver over tile set's adjacency
+//every cell keeps domain of possible tiles, solver always collapses cell with
+//the lowest Shannon entropy and then propagates arc consistency to neighbours
+//on contradiction it reverts the latest decisions by undo trail of domain changes
+class WfcSolver{
+private:
+    //old value of domain's word
+    struct TrailEntry{
+        uint32_t cell;
+        uint32_t word;
+        uint64_t bits;
+    };
+
+    struct Decision{
+        uint32_t cell;
+        uint32_t tile;
+        size_t trailSize; //size of trail before decision
+    };
+
+    const TileAdjacency& m_adjacency;
+    const TileSampler& m_sampler;
+    std::vector<double> m_weights;           //chanse of every tile
+    std::vector<double> m_weightLogWeights;  //chanse * log(chanse) of every tile
+    size_t m_words;
+    size_t m_stride; //words between domains of cells, domains of big tile sets are padded to 512 bits
+    cv::Size m_size;
+    WfcConfig m_config;
+    const BitOps& m_bitOps; //operations over domains of big tile sets
+
+    AlignedWords m_domains; //[cell * m_stride + word]
+    AlignedWords m_initialDomains; //domains before first collapse, for restarts
+    std::vector<uint32_t> m_counts;  //count of possible tiles in cell, 0 - cell is empty
+    std::vector<double> m_sumWeights;
+    std::vector<double> m_sumWeightLogWeights;
+    IndexedHeap m_entropyHeap; //not collapsed cells by entropy, key is updated when domain is changed
+
+    std::vector<uint32_t> m_worklist; //cells whose domain was changed and not propagated yet
+    std::vector<uint8_t> m_inWorklist;
+    AlignedWords m_allowed;  //buffer for neighbour's allowed tiles
+    AlignedWords m_removed;  //buffer for tiles removed from domain
+    std::vector<uint32_t> m_sideStamps; //for skip side which was already added to m_allowed
+    uint32_t m_stamp = 0;
+
+    std::vector<TrailEntry> m_trail;
+    std::vector<Decision> m_decisions;
+    std::vector<uint32_t> m_touched; //cells restored from trail
+    std::vector<uint8_t> m_isTouched;
+    bool m_contradiction = false;
+    uint32_t m_contradictionCell = 0;
+    bool m_allowHoles = false;  //contradiction leaves empty cell instead of backtracking
+    size_t m_backtracksLeft = 0;
+    size_t m_restartsLeft = 0;
+    size_t m_episodeDepth = SIZE_MAX; //count of decisions when current contradiction happened
+    size_t m_collapsesAtRestart = 0;
+    uint32_t m_regionRadius = 0;
+
+    Rng m_rng;
+    WfcStats m_stats;
+    void (WfcSolver::*m_propagateKernel)() = nullptr; //kernel chosen by count of words of tile set
+
+private:
+    uint64_t* _domain(uint32_t cell) noexcept{ return m_domains.data() + cell * m_stride; }
+    double _entropy(uint32_t cell) const;
+    //update cell's entropy in heap, cell is removed from heap if it's collapsed or empty
+    void _pushEntropy(uint32_t cell);
+    //recalculate count and weights of cell by it domain
+    void _recount(uint32_t cell);
+    //recalculate count and weights after removing tiles removed from cell's domain
+    //WORDS - count of words in domain known at compile time, 0 - m_words
+    template<size_t WORDS = 0>
+    void _removeTiles(uint32_t cell, const uint64_t* removed);
+    //save word of domain to trail before changing it
+    void _saveWord(uint32_t cell, size_t word);
+    //return true if cell's domain was changed
+    template<size_t WORDS = 0>
+    bool _constrain(uint32_t cell, const uint64_t* allowed);
+    void _pushWorklist(uint32_t cell);
+    void _propagate();
+    //propagation specialised on count of words, loops over words of domains are unrolled
+    //and domains of small tile sets stay in registers, 0 - any count of words by m_bitOps
+    template<size_t WORDS>
+    void _propagateKernel();
+    template<size_t WORDS>
+    size_t _words() const noexcept{ return WORDS > 0 ? WORDS : m_words; }
+    //return cell with the lowest entropy or UINT32_MAX if all cells are collapsed
+    uint32_t _pickCell();
+    void _collapse(uint32_t cell);
+
+    //drop decisions which are too old for backtracking
+    void _compactTrail();
+    //restore domains from trail to given trail size
+    void _revert(size_t trailSize);
+    //reset domains of cells in rect to initial domains
+    void _resetRegion(cv::Rect region);
+    //resolve contradiction by backtracking, restart or leaving empty cell
+    void _resolveContradiction();
+
+public:
+    WfcSolver(TileSet& tileSet, const WfcConfig& config = WfcConfig());
+
+    //set all cells to full domain
+    void reset(cv::Size size);
+    //keep in cell's domain only allowed tiles, it's propagated to other cells by run()
+    //should be called after reset() and before run(), cell becomes empty if nothing is allowed
+    //allowed - bitset of TileAdjacency::getWordsCount() words
+    void restrictCell(uint32_t x, uint32_t y, const uint64_t* allowed);
+    //keep only one tile in the cell
+    void pinCell(uint32_t x, uint32_t y, size_t tileId);
+    //restrict cells by restricted cells of constraints, it should be called before run() like restrictCell()
+    //constraints should be built for tile set of solver
+    //offset - cell of constraints which is cell (0, 0) of solver
+    void restrictCells(const MapConstraints& constraints, cv::Point offset = cv::Point(0, 0));
+    //collapse all cells
+    //same seed, constraints and tile set give the same map
+    WfcStats run(uint64_t seed);
+
+    cv::Size getSize() const noexcept;
+    //return tile id + 1 for collapsed cell or 0 for empty cell
+    size_t getCell(uint32_t x, uint32_t y) const noexcept;
+};
@@ -0,0 +1,49 @@
+#include "../include/batchGenerator.h"
+#include "../include/tilesMap.h"
+#include <chrono>
+
+
+BatchGenerator::BatchGenerator(TileSet& tileSet, size_t threads, const WfcConfig& config)
+                              :m_tileSet(tileSet), m_pool(threads),
+                               m_tilesCount(tileSet.getAdjacency().getTilesCount()){
+    for(size_t i = 0; i < m_pool.getThreadsCount(); i++){
+        m_solvers.push_back(std::make_unique<WfcSolver>(m_tileSet, config));
+    }
+    m_maps.resize(m_pool.getThreadsCount());
+}
+
+size_t BatchGenerator::getThreadsCount() const noexcept{
+    return m_pool.getThreadsCount();
+}
+
+BatchStats BatchGenerator::generate(cv::Size sizeMap, const std::vector<uint64_t>& seeds, const Callback& callback){
+    BatchStats result;
+    const auto start = std::chrono::steady_clock::now();
+
+    for(auto& map: m_maps){
+        map = TileIdGrid(sizeMap, m_tilesCount);
+    }
+
+    m_pool.parallelFor(seeds.size(), [&](size_t i){
+        const size_t worker = ThreadPool::currentWorker();
+        WfcSolver& solver = *m_solvers[worker];
+        TileIdGrid& map = m_maps[worker];
+
+        solver.reset(sizeMap);
+        const WfcStats stats = solver.run(seeds[i]);
+        for(int y = 0; y < sizeMap.height; y++){
+            for(int x = 0; x < sizeMap.width; x++){
+                map.set(x, y, solver.getCell(x, y));
+            }
+        }
+
+        std::lock_guard lock(m_callbackMutex);
+        result.wfc += stats;
+        result.maps++;
+        if(callback) callback(i, seeds[i], map, stats);
+    });
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.mapsPerSecond = result.seconds > 0 ? result.maps / result.seconds : 0;
+    return result;
+}
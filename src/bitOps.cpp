@@ -0,0 +1,117 @@
+#include "../include/bitOps.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #include <immintrin.h>
+    #define WFC_X86_SIMD
+#endif
+
+
+namespace{
+    void orIntoScalar(uint64_t* dst, const uint64_t* src, size_t words){
+        for(size_t i = 0; i < words; i++) dst[i] |= src[i];
+    }
+
+    uint32_t subtractScalar(const uint64_t* domain, const uint64_t* allowed, uint64_t* removed, size_t words){
+        uint64_t anyRemoved = 0, anyLeft = 0;
+        for(size_t i = 0; i < words; i++){
+            removed[i] = domain[i] & ~allowed[i];
+            anyRemoved |= removed[i];
+            anyLeft |= domain[i] & allowed[i];
+        }
+        return (anyLeft ? BitOps::ANY_LEFT : 0) | (anyRemoved ? BitOps::ANY_REMOVED : 0);
+    }
+
+#ifdef WFC_X86_SIMD
+    //tail of bitset shorter than vector is processed by scalar code
+
+    __attribute__((target("avx2")))
+    void orIntoAvx2(uint64_t* dst, const uint64_t* src, size_t words){
+        size_t i = 0;
+        for(; i + 4 <= words; i += 4){
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(a, b));
+        }
+        orIntoScalar(dst + i, src + i, words - i);
+    }
+
+    __attribute__((target("avx2")))
+    uint32_t subtractAvx2(const uint64_t* domain, const uint64_t* allowed, uint64_t* removed, size_t words){
+        __m256i anyRemoved = _mm256_setzero_si256();
+        __m256i anyLeft = _mm256_setzero_si256();
+        size_t i = 0;
+        for(; i + 4 <= words; i += 4){
+            const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(domain + i));
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(allowed + i));
+            const __m256i r = _mm256_andnot_si256(a, d);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(removed + i), r);
+            anyRemoved = _mm256_or_si256(anyRemoved, r);
+            anyLeft = _mm256_or_si256(anyLeft, _mm256_and_si256(d, a));
+        }
+        uint32_t result = subtractScalar(domain + i, allowed + i, removed + i, words - i);
+        if(!_mm256_testz_si256(anyLeft, anyLeft)) result |= BitOps::ANY_LEFT;
+        if(!_mm256_testz_si256(anyRemoved, anyRemoved)) result |= BitOps::ANY_REMOVED;
+        return result;
+    }
+
+    __attribute__((target("avx512f")))
+    void orIntoAvx512(uint64_t* dst, const uint64_t* src, size_t words){
+        size_t i = 0;
+        for(; i + 8 <= words; i += 8){
+            const __m512i a = _mm512_loadu_si512(dst + i);
+            const __m512i b = _mm512_loadu_si512(src + i);
+            _mm512_storeu_si512(dst + i, _mm512_or_si512(a, b));
+        }
+        //tail is done by one masked operation
+        if(i < words){
+            const __mmask8 mask = static_cast<__mmask8>((1u << (words - i)) - 1);
+            const __m512i a = _mm512_maskz_loadu_epi64(mask, dst + i);
+            const __m512i b = _mm512_maskz_loadu_epi64(mask, src + i);
+            _mm512_mask_storeu_epi64(dst + i, mask, _mm512_or_si512(a, b));
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    uint32_t subtractAvx512(const uint64_t* domain, const uint64_t* allowed, uint64_t* removed, size_t words){
+        __m512i anyRemoved = _mm512_setzero_si512();
+        __m512i anyLeft = _mm512_setzero_si512();
+        for(size_t i = 0; i < words; i += 8){
+            const __mmask8 mask = words - i >= 8 ? 0xFF : static_cast<__mmask8>((1u << (words - i)) - 1);
+            const __m512i d = _mm512_maskz_loadu_epi64(mask, domain + i);
+            const __m512i a = _mm512_maskz_loadu_epi64(mask, allowed + i);
+            const __m512i left = _mm512_and_si512(d, a);
+            const __m512i r = _mm512_xor_si512(d, left);
+            _mm512_mask_storeu_epi64(removed + i, mask, r);
+            anyRemoved = _mm512_or_si512(anyRemoved, r);
+            anyLeft = _mm512_or_si512(anyLeft, left);
+        }
+        return (_mm512_test_epi64_mask(anyLeft, anyLeft) ? BitOps::ANY_LEFT : 0)
+             | (_mm512_test_epi64_mask(anyRemoved, anyRemoved) ? BitOps::ANY_REMOVED : 0);
+    }
+#endif
+
+    const BitOps SCALAR_OPS{orIntoScalar, subtractScalar, "scalar"};
+#ifdef WFC_X86_SIMD
+    const BitOps AVX2_OPS{orIntoAvx2, subtractAvx2, "avx2"};
+    const BitOps AVX512_OPS{orIntoAvx512, subtractAvx512, "avx512"};
+#endif
+}
+
+const BitOps& BitOps::scalar(){
+    return SCALAR_OPS;
+}
+
+std::vector<const BitOps*> BitOps::supported(){
+    std::vector<const BitOps*> ops = {&SCALAR_OPS};
+#ifdef WFC_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) ops.push_back(&AVX2_OPS);
+    if(__builtin_cpu_supports("avx512f")) ops.push_back(&AVX512_OPS);
+#endif
+    return ops;
+}
+
+const BitOps& BitOps::best(){
+    static const BitOps* ops = supported().back();
+    return *ops;
+}
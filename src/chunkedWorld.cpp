@@ -0,0 +1,140 @@
+#include "../include/chunkedWorld.h"
+#include "../include/tilesMap.h"
+#include "../include/rng.h"
+
+
+namespace{
+    enum WorldPart : uint32_t{
+        CORNER = 1,
+        HORIZONTAL_SEAM,
+        VERTICAL_SEAM,
+        CHUNK
+    };
+
+    int64_t floorDiv(int64_t a, int64_t b){
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+}
+
+ChunkedWorld::ChunkedWorld(TileSet& tileSet, uint64_t seed, int chunkSize, size_t maxChunks, const WfcConfig& config)
+                          :m_tileSet(tileSet), m_solver(tileSet, config), m_renderer(1), m_seed(seed),
+                           m_chunkSize(chunkSize), m_maxChunks(maxChunks),
+                           m_tilesCount(tileSet.getAdjacency().getTilesCount()){
+    if(m_chunkSize < 2)
+        throw std::runtime_error("ChunkedWorld: chunk size should be at least 2");
+    if(m_maxChunks == 0)
+        throw std::runtime_error("ChunkedWorld: max count of chunks should be at least 1");
+
+    m_renderer.build(m_tileSet, m_tilesCount);
+}
+
+int64_t ChunkedWorld::_chunkKey(int cx, int cy) noexcept{
+    return (static_cast<int64_t>(cx) << 32) | static_cast<uint32_t>(cy);
+}
+
+uint64_t ChunkedWorld::_partSeed(uint32_t part, int cx, int cy) const noexcept{
+    return deriveSeed(m_seed, part, static_cast<uint32_t>(cx), static_cast<uint32_t>(cy));
+}
+
+size_t ChunkedWorld::_cornerTile(int cx, int cy){
+    m_solver.reset({1, 1});
+    m_solver.run(_partSeed(CORNER, cx, cy));
+    return m_solver.getCell(0, 0);
+}
+
+std::vector<size_t> ChunkedWorld::_horizontalSeam(int cx, int cy){
+    const size_t first = _cornerTile(cx, cy);
+    const size_t last = _cornerTile(cx + 1, cy);
+
+    m_solver.reset({m_chunkSize + 1, 1});
+    if(first) m_solver.pinCell(0, 0, first - 1);
+    if(last) m_solver.pinCell(m_chunkSize, 0, last - 1);
+    m_solver.run(_partSeed(HORIZONTAL_SEAM, cx, cy));
+
+    std::vector<size_t> seam(m_chunkSize + 1);
+    for(int i = 0; i <= m_chunkSize; i++){
+        seam[i] = m_solver.getCell(i, 0);
+    }
+    return seam;
+}
+
+std::vector<size_t> ChunkedWorld::_verticalSeam(int cx, int cy){
+    const size_t first = _cornerTile(cx, cy);
+    const size_t last = _cornerTile(cx, cy + 1);
+
+    m_solver.reset({1, m_chunkSize + 1});
+    if(first) m_solver.pinCell(0, 0, first - 1);
+    if(last) m_solver.pinCell(0, m_chunkSize, last - 1);
+    m_solver.run(_partSeed(VERTICAL_SEAM, cx, cy));
+
+    std::vector<size_t> seam(m_chunkSize + 1);
+    for(int i = 0; i <= m_chunkSize; i++){
+        seam[i] = m_solver.getCell(0, i);
+    }
+    return seam;
+}
+
+TileIdGrid ChunkedWorld::_generateChunk(int cx, int cy){
+    const std::vector<size_t> top = _horizontalSeam(cx, cy);
+    const std::vector<size_t> bottom = _horizontalSeam(cx, cy + 1);
+    const std::vector<size_t> left = _verticalSeam(cx, cy);
+    const std::vector<size_t> right = _verticalSeam(cx + 1, cy);
+
+    //chunk is solved with seams of all neighbours, but only own seams are stored in it
+    const int size = m_chunkSize;
+    m_solver.reset({size + 1, size + 1});
+    for(int i = 0; i <= size; i++){
+        if(top[i]) m_solver.pinCell(i, 0, top[i] - 1);
+        if(bottom[i]) m_solver.pinCell(i, size, bottom[i] - 1);
+        if(left[i]) m_solver.pinCell(0, i, left[i] - 1);
+        if(right[i]) m_solver.pinCell(size, i, right[i] - 1);
+    }
+    m_solver.run(_partSeed(CHUNK, cx, cy));
+
+    TileIdGrid chunk({size, size}, m_tilesCount);
+    for(int y = 0; y < size; y++){
+        for(int x = 0; x < size; x++){
+            chunk.set(x, y, m_solver.getCell(x, y));
+        }
+    }
+    //empty seam cells stay empty to match neighbour chunks
+    for(int i = 0; i < size; i++){
+        if(!top[i]) chunk.set(i, 0, 0);
+        if(!left[i]) chunk.set(0, i, 0);
+    }
+    return chunk;
+}
+
+int ChunkedWorld::getChunkSize() const noexcept{
+    return m_chunkSize;
+}
+
+const TileIdGrid& ChunkedWorld::getChunk(int cx, int cy){
+    const int64_t key = _chunkKey(cx, cy);
+    auto it = m_chunksIndex.find(key);
+    if(it != m_chunksIndex.end()){
+        m_chunks.splice(m_chunks.begin(), m_chunks, it->second);
+        return m_chunks.front().tiles;
+    }
+
+    if(m_chunks.size() >= m_maxChunks){
+        m_chunksIndex.erase(m_chunks.back().key);
+        m_chunks.pop_back();
+    }
+    m_chunks.push_front({key, _generateChunk(cx, cy)});
+    m_chunksIndex[key] = m_chunks.begin();
+    return m_chunks.front().tiles;
+}
+
+size_t ChunkedWorld::getCell(int64_t x, int64_t y){
+    const int64_t cx = floorDiv(x, m_chunkSize);
+    const int64_t cy = floorDiv(y, m_chunkSize);
+    const TileIdGrid& chunk = getChunk(static_cast<int>(cx), static_cast<int>(cy));
+    return chunk.get(static_cast<int>(x - cx * m_chunkSize), static_cast<int>(y - cy * m_chunkSize));
+}
+
+cv::Mat ChunkedWorld::renderChunk(int cx, int cy){
+    cv::Mat image;
+    m_renderer.render(getChunk(cx, cy), image);
+    return image;
+}
@@ -0,0 +1,42 @@
+#include "../include/edgeCompatibility.h"
+#include <stdexcept>
+
+
+bool EdgeCompatibility::_matches(const std::string& pattern, const std::string& side) noexcept{
+    if(pattern.size() != side.size()) return false;
+    for(size_t i = 0; i < side.size(); i++){
+        if(pattern[i] != side[i] && pattern[i] != WILDCARD && side[i] != WILDCARD) return false;
+    }
+    return true;
+}
+
+void EdgeCompatibility::allow(const std::string& a, const std::string& b){
+    allowDirected(a, b);
+    if(a != b) allowDirected(b, a);
+}
+
+void EdgeCompatibility::allowDirected(const std::string& first, const std::string& second){
+    if(first.empty() || second.empty())
+        throw std::runtime_error("EdgeCompatibility: side of rule is empty");
+    m_rules.emplace_back(first, second);
+}
+
+const std::vector<std::pair<std::string, std::string>>& EdgeCompatibility::getRules() const noexcept{
+    return m_rules;
+}
+
+bool EdgeCompatibility::empty() const noexcept{
+    return m_rules.empty();
+}
+
+bool EdgeCompatibility::isCompatible(const std::string& a, const std::string& b) const noexcept{
+    if(_matches(a, b)) return true;
+    for(const auto& [first, second]: m_rules){
+        if(_matches(first, a) && _matches(second, b)) return true;
+    }
+    return false;
+}
+
+bool EdgeCompatibility::hasWildcard(const std::string& side) noexcept{
+    return side.find(WILDCARD) != std::string::npos;
+}
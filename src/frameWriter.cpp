@@ -0,0 +1,114 @@
+#include "../include/frameWriter.h"
+#include <filesystem>
+#include <opencv2/opencv.hpp>
+
+
+FrameWriter::FrameWriter(const FrameOutput& output, cv::Size frameSize):m_output(output){
+    if(m_output.queueSize == 0)
+        throw std::runtime_error("FrameWriter: queue size should be at least 1");
+
+    if(m_output.format == FrameFormat::Images){
+        std::filesystem::create_directories(m_output.path);
+    }
+    else{
+        const std::filesystem::path parent = std::filesystem::path(m_output.path).parent_path();
+        if(!parent.empty()) std::filesystem::create_directories(parent);
+    }
+    m_thread = std::thread(&FrameWriter::_writerLoop, this, frameSize);
+}
+
+FrameWriter::~FrameWriter(){
+    try{
+        finish();
+    }
+    catch(...){}
+}
+
+void FrameWriter::_writerLoop(cv::Size frameSize){
+    cv::VideoWriter video;
+    cv::Mat bgr;
+    size_t index = 0;
+
+    try{
+        if(m_output.format == FrameFormat::Video){
+            video.open(m_output.path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), m_output.fps, frameSize, true);
+            if(!video.isOpened())
+                throw std::runtime_error("FrameWriter: can't open video \"" + m_output.path + "\"");
+        }
+
+        while(true){
+            cv::Mat frame;
+            {
+                std::unique_lock lock(m_mutex);
+                m_frameAdded.wait(lock, [&]{ return m_stop || !m_frames.empty(); });
+                if(m_frames.empty()) break;
+                frame = std::move(m_frames.front());
+                m_frames.pop_front();
+            }
+
+            if(m_output.format == FrameFormat::Images){
+                const std::string path = m_output.path + "/" + std::to_string(index) + ".png";
+                if(!cv::imwrite(path, frame))
+                    throw std::runtime_error("FrameWriter: can't write \"" + path + "\"");
+            }
+            else{
+                //frames have type of tiles, but video is always 3 channels without alpha
+                if(frame.channels() == 1) cv::cvtColor(frame, bgr, cv::COLOR_GRAY2BGR);
+                else if(frame.channels() == 4) cv::cvtColor(frame, bgr, cv::COLOR_BGRA2BGR);
+                else bgr = frame;
+                video.write(bgr);
+            }
+            index++;
+
+            std::lock_guard lock(m_mutex);
+            m_free.push_back(std::move(frame));
+            m_frameWritten.notify_one();
+        }
+    }
+    catch(...){
+        std::lock_guard lock(m_mutex);
+        m_exception = std::current_exception();
+        m_frames.clear();
+        m_frameWritten.notify_all();
+    }
+}
+
+void FrameWriter::push(const cv::Mat& frame){
+    cv::Mat buffer;
+    {
+        std::unique_lock lock(m_mutex);
+        m_frameWritten.wait(lock, [&]{ return m_exception || m_frames.size() < m_output.queueSize; });
+        if(m_exception) return;
+        if(!m_free.empty()){
+            buffer = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    //copy without lock, writer thread works in parallel
+    frame.copyTo(buffer);
+
+    std::lock_guard lock(m_mutex);
+    m_frames.push_back(std::move(buffer));
+    m_framesCount++;
+    m_frameAdded.notify_one();
+}
+
+void FrameWriter::finish(){
+    if(!m_thread.joinable()) return;
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_frameAdded.notify_one();
+    m_thread.join();
+
+    if(m_exception){
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+size_t FrameWriter::getFramesCount() const noexcept{
+    return m_framesCount;
+}
@@ -1,43 +1,251 @@
 #include <iostream>
 #include <filesystem>
 #include <string>
+#include <map>
 #include <opencv2/opencv.hpp>
 #include "../include/tilesMap.h"
+#include "../include/mapFile.h"
+#include "../include/tileSetManifest.h"
+#include "../include/overlappingModel.h"
+#include "../include/tilePyramid.h"
 
-int main(){
-    
-    // TileSet tileSet(1, {48, 48});
-
-    // Tile tile1(TileImage("../data/set_1/1.png"), TileSides(1, "0000"), 300);
-    // Tile tile2(TileImage("../data/set_1/2.png", tile1.getImage()), TileSides(1, "0101"), 100);
-    // Tile tile3(TileImage("../data/set_1/3.png", tile1.getImage()), TileSides(1, "1001"), 0);
-    // Tile tile4(TileImage("../data/set_1/4.png", tile1.getImage()), TileSides(1, "1111"), 100);
-    // Tile tile5(TileImage("../data/set_1/5.png", tile1.getImage()), TileSides(1, "0100"), 0);
-    // Tile tile6(TileImage("../data/set_1/6.png", tile1.getImage()), TileSides(1, "1011"), 0);
-    
-    TileSet tileSet(1, {24, 24});
-
-    Tile tile1(TileImage("../data/set_2/1.png"), TileSides(1, "0000"), 5);
-    Tile tile2(TileImage("../data/set_2/2.png", tile1.getImage()), TileSides(1, "1010"), 1);
-    Tile tile3(TileImage("../data/set_2/3.png", tile1.getImage()), TileSides(1, "0110"), 1);
-    Tile tile4(TileImage("../data/set_2/4.png", tile1.getImage()), TileSides(1, "1111"), 1);
-    Tile tile5(TileImage("../data/set_2/5.png", tile1.getImage()), TileSides(1, "1110"), 1);
-    Tile tile6(TileImage("../data/set_2/6.png", tile1.getImage()), TileSides(1, "0010"), 1);
-
-    tileSet.addTile(tile1);
-    tileSet.addTile(tile2);
-    tileSet.addTile(tile3);
-    tileSet.addTile(tile4);
-    tileSet.addTile(tile5);
-    tileSet.addTile(tile6);
-
-    tileSet.saveCurrentTileSet("current_tile_set");
+struct Options{
+    std::string command = "generate";
+    std::vector<std::string> arguments; //arguments of command
+    std::string manifest = "../data/set_2/manifest.txt";
+    std::string tileSetCache;
+    std::string sample;
+    int patternSize = 3;
+    cv::Size size = {100, 100};
+    uint64_t seed = 0;
+    size_t threads = 0;
+    std::string mode = "greedy";
+    std::string format = "png";
+    std::string out; //default depends on command
+    int imageTile = 1024;
+    std::string imageFormat = "png";
+    bool mipmaps = true;
+    std::string saveTiles;
+    std::string trace;
+};
 
+void printUsage(const char* name){
+    std::cout<<"Usage:\n"
+             <<"  "<<name<<" [generate] [options]                        generate map\n"
+             <<"  "<<name<<" render <map file> <x> <y> <width> <height> [options]\n"
+             <<"                                                  render rect of cells from map file\n"
+             <<"  "<<name<<" render <map file> --format tiles [options]\n"
+             <<"                                                  render whole map file to image tiles\n"
+             <<"  "<<name<<" cache [options]                             compile tile set to cache file\n"
+             <<"Options:\n"
+             <<"  --manifest <file>      tile set manifest (../data/set_2/manifest.txt)\n"
+             <<"  --tileset-cache <file> compiled tile set instead of manifest\n"
+             <<"  --sample <image>       learn patterns of overlapping model from image instead of manifest\n"
+             <<"  --pattern-size <n>     width and height of patterns of sample (3)\n"
+             <<"  --size <width>x<height> size of map in tiles (100x100)\n"
+             <<"  --seed <n>             seed of generation (0)\n"
+             <<"  --threads <n>          count of threads, 0 - count of hardware threads (0)\n"
+             <<"  --mode <mode>          greedy, wfc or parallel (greedy)\n"
+             <<"  --format <format>      png - image, map - binary map file, steps - image of every step\n"
+             <<"                         to directory, video - video of steps, tiles - image tiles z/x/y\n"
+             <<"                         with mipmaps and index.html viewer to directory (png)\n"
+             <<"  --out <path>           output file or directory (abb.png, tileset.cache for cache)\n"
+             <<"  --image-tile <n>       width and height of image tiles in pixels (1024)\n"
+             <<"  --image-format <format> png or webp format of image tiles (png)\n"
+             <<"  --mipmaps <0|1>        write downsampled zooms of image tiles (1)\n"
+             <<"  --save-tiles <dir>     save all rotated tiles of tile set as images\n"
+             <<"  --trace <file>         write statistics and trace events of generation for trace viewer,\n"
+             <<"                         time of hot paths is measured only in build with ENABLE_PROFILING\n";
+}
+
+Options parseOptions(int argc, char** argv){
+    Options options;
+    int i = 1;
+    if(i < argc && argv[i][0] != '-') options.command = argv[i++];
+
+    for(; i < argc; i++){
+        const std::string arg = argv[i];
+        if(arg.rfind("--", 0) != 0){
+            options.arguments.push_back(arg);
+            continue;
+        }
+        if(arg == "--help") throw std::invalid_argument("");
+        if(i + 1 >= argc) throw std::invalid_argument("option " + arg + " needs value");
+        const std::string value = argv[++i];
+
+        if(arg == "--manifest") options.manifest = value;
+        else if(arg == "--tileset-cache") options.tileSetCache = value;
+        else if(arg == "--sample") options.sample = value;
+        else if(arg == "--pattern-size") options.patternSize = std::stoi(value);
+        else if(arg == "--size"){
+            const size_t x = value.find('x');
+            if(x == std::string::npos) throw std::invalid_argument("size should be <width>x<height>");
+            options.size = {std::stoi(value.substr(0, x)), std::stoi(value.substr(x + 1))};
+        }
+        else if(arg == "--seed") options.seed = std::stoull(value);
+        else if(arg == "--threads") options.threads = std::stoul(value);
+        else if(arg == "--mode") options.mode = value;
+        else if(arg == "--format") options.format = value;
+        else if(arg == "--out") options.out = value;
+        else if(arg == "--image-tile") options.imageTile = std::stoi(value);
+        else if(arg == "--image-format") options.imageFormat = value;
+        else if(arg == "--mipmaps") options.mipmaps = std::stoi(value) != 0;
+        else if(arg == "--save-tiles") options.saveTiles = value;
+        else if(arg == "--trace") options.trace = value;
+        else throw std::invalid_argument("unknown option " + arg);
+    }
+    //cache isn't an image, so it doesn't overwrite rendered map by default
+    if(options.out.empty()) options.out = options.command == "cache" ? "tileset.cache" : "abb.png";
+    return options;
+}
+
+TileSet loadTileSet(const Options& options){
+    if(!options.tileSetCache.empty()) return TileSet::loadCache(options.tileSetCache);
+    if(!options.sample.empty()){
+        const cv::Mat sample = cv::imread(options.sample, cv::IMREAD_COLOR);
+        if(sample.empty()) throw std::runtime_error("can't load sample \"" + options.sample + "\"");
+        OverlappingConfig config;
+        config.patternSize = options.patternSize;
+        return OverlappingModel(sample, config).createTileSet();
+    }
+    return TileSetManifest(options.manifest).createTileSet(options.threads);
+}
+
+PyramidOutput pyramidOutput(const Options& options){
+    PyramidOutput output;
+    output.path = options.out;
+    output.tileSize = options.imageTile;
+    output.format = options.imageFormat;
+    output.mipmaps = options.mipmaps;
+    output.threads = options.threads;
+    return output;
+}
+
+//write map as image tiles, rows of map are rendered by bands, so whole image isn't created
+void writePyramid(TileSet& tileSet, const TileIdGrid& map, const Options& options){
+    TileRenderer renderer(options.threads);
+    renderer.build(tileSet, tileSet.getAdjacency().getTilesCount());
+    TilePyramidWriter(renderer, pyramidOutput(options)).write(map);
+}
+
+int generate(TileSet& tileSet, const Options& options){
+    if(options.mode != "greedy" && options.mode != "wfc" && options.mode != "parallel"){
+        std::cout<<"Error: unknown mode \""<<options.mode<<"\".\n";
+        return 1;
+    }
+    const bool steps = options.format == "steps" || options.format == "video";
+    if(!steps && options.format != "png" && options.format != "map" && options.format != "tiles"){
+        std::cout<<"Error: unknown format \""<<options.format<<"\".\n";
+        return 1;
+    }
     TileMapGenerator mapGenerator;
-    mapGenerator.generateMap(tileSet, {100, 100});
-    //mapGenerator.generateMap_saveSteps(tileSet, {20,20}, "generated_steps");
+    Profiler::instance().reset();
+
+    if(steps){
+        if(options.mode != "greedy"){
+            std::cout<<"Error: steps are saved only in greedy mode.\n";
+            return 1;
+        }
+        FrameOutput output;
+        output.format = options.format == "steps" ? FrameFormat::Images : FrameFormat::Video;
+        output.path = options.out;
+        mapGenerator.generateMap_saveSteps(tileSet, options.size, output, options.seed);
+        if(!options.trace.empty()) Profiler::instance().writeTrace(options.trace, mapGenerator.getStats());
+        return 0;
+    }
 
-    cv::imwrite("abb.png", mapGenerator.getMap());
-    cv::waitKey();
+    if(options.mode == "greedy"){
+        mapGenerator.generateMap(tileSet, options.size, options.seed);
+    }
+    else if(options.mode == "wfc"){
+        mapGenerator.generateMapWfc(tileSet, options.size, options.seed);
+    }
+    else{
+        ParallelConfig config;
+        config.threads = options.threads;
+        mapGenerator.generateMapParallel(tileSet, options.size, options.seed, config);
+    }
+    if(!options.trace.empty()) Profiler::instance().writeTrace(options.trace, mapGenerator.getStats());
+
+    //map file and image tiles are written from tile ids, so map isn't rendered
+    if(options.format == "png"){
+        cv::imwrite(options.out, mapGenerator.getMap());
+    }
+    else if(options.format == "map"){
+        MapFileWriter writer(options.out, options.size, tileSet.getHash(), tileSet.getAdjacency().getTilesCount());
+        writer.writeMap(mapGenerator.getTileMap());
+        writer.finish();
+    }
+    else{
+        writePyramid(tileSet, mapGenerator.getTileMap(), options);
+    }
+    return 0;
+}
+
+//render rect of cells or whole map from map file
+int renderMap(TileSet& tileSet, const Options& options){
+    const auto& args = options.arguments;
+    const bool wholeMap = args.size() == 1 && options.format == "tiles";
+    if(args.size() != 5 && !wholeMap){
+        std::cout<<"Error: render needs <map file> <x> <y> <width> <height> or <map file> with --format tiles.\n";
+        return 1;
+    }
+    MapFileReader reader(args[0]);
+    if(reader.getTileSetHash() != tileSet.getHash()){
+        std::cout<<"Error: map \""<<args[0]<<"\" was generated with other tile set.\n";
+        return 1;
+    }
+
+    TileRenderer renderer(options.threads);
+    renderer.build(tileSet, tileSet.getAdjacency().getTilesCount());
+    if(wholeMap){
+        //only chunks of map file under current row of image tiles are decoded
+        TilePyramidWriter(renderer, pyramidOutput(options)).write(reader);
+        return 0;
+    }
+
+    const cv::Rect rect(std::stoi(args[1]), std::stoi(args[2]), std::stoi(args[3]), std::stoi(args[4]));
+    if(rect.width <= 0 || rect.height <= 0){
+        std::cout<<"Error: width and height of rect should be positive.\n";
+        return 1;
+    }
+    if(options.format == "tiles"){
+        TilePyramidWriter(renderer, pyramidOutput(options)).write(reader.read(rect));
+        return 0;
+    }
+    cv::Mat image;
+    renderer.render(reader.read(rect), image);
+    cv::imwrite(options.out, image);
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char** argv){
+    Options options;
+    try{
+        options = parseOptions(argc, argv);
+    }
+    catch(const std::exception& e){
+        if(*e.what()) std::cout<<"Error: "<<e.what()<<".\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try{
+        TileSet tileSet = loadTileSet(options);
+        if(!options.saveTiles.empty()) tileSet.saveCurrentTileSet(options.saveTiles);
+
+        if(options.command == "generate") return generate(tileSet, options);
+        if(options.command == "render") return renderMap(tileSet, options);
+        if(options.command == "cache"){
+            tileSet.saveCache(options.out);
+            return 0;
+        }
+        std::cout<<"Error: unknown command \""<<options.command<<"\".\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+    catch(const std::exception& e){
+        std::cout<<"Error: "<<e.what()<<"\n";
+        return 1;
+    }
+}
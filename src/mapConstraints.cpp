@@ -0,0 +1,112 @@
+#include "../include/mapConstraints.h"
+#include "../include/tilesMap.h"
+
+
+MapConstraints::MapConstraints(TileSet& tileSet, cv::Size size)
+                              :m_adjacency(tileSet.getAdjacency()), m_size(size), m_words(m_adjacency.getWordsCount()),
+                               m_tilesCount(m_adjacency.getTilesCount()), m_tileSetHash(tileSet.getHash()){
+    const uint64_t* all = m_adjacency.getAllTilesMask();
+    m_masks.resize(static_cast<size_t>(size.area()) * m_words);
+    for(size_t i = 0; i < static_cast<size_t>(size.area()); i++){
+        std::copy(all, all + m_words, m_masks.begin() + i * m_words);
+    }
+    m_restricted.assign(size.area(), 0);
+}
+
+cv::Size MapConstraints::getSize() const noexcept{
+    return m_size;
+}
+
+size_t MapConstraints::getWordsCount() const noexcept{
+    return m_words;
+}
+
+size_t MapConstraints::getTilesCount() const noexcept{
+    return m_tilesCount;
+}
+
+uint64_t MapConstraints::getTileSetHash() const noexcept{
+    return m_tileSetHash;
+}
+
+void MapConstraints::checkTileSet(TileSet& tileSet) const{
+    //counts are compared first, masks of other count of words would be read out of bounds
+    if(tileSet.getAdjacency().getTilesCount() != m_tilesCount || tileSet.getHash() != m_tileSetHash)
+        throw std::runtime_error("MapConstraints: constraints were built for other tile set");
+}
+
+void MapConstraints::_checkCell(int x, int y) const{
+    if(x < 0 || y < 0 || x >= m_size.width || y >= m_size.height)
+        throw std::runtime_error("MapConstraints: cell (" + std::to_string(x) + ", " + std::to_string(y) + ") is out of map");
+}
+
+void MapConstraints::allowTiles(int x, int y, const uint64_t* allowed){
+    _checkCell(x, y);
+    uint64_t* mask = _mask(x, y);
+    for(size_t i = 0; i < m_words; i++){
+        mask[i] &= allowed[i];
+    }
+    m_restricted[static_cast<size_t>(y) * m_size.width + x] = 1;
+}
+
+void MapConstraints::allowTiles(cv::Rect region, const uint64_t* allowed){
+    region &= cv::Rect(cv::Point(0, 0), m_size);
+    for(int y = region.y; y < region.y + region.height; y++){
+        for(int x = region.x; x < region.x + region.width; x++){
+            allowTiles(x, y, allowed);
+        }
+    }
+}
+
+void MapConstraints::pinTile(int x, int y, size_t tileId){
+    if(tileId >= m_adjacency.getTilesCount())
+        throw std::runtime_error("MapConstraints: wrong tile id " + std::to_string(tileId));
+
+    std::vector<uint64_t> allowed(m_words, 0);
+    allowed[tileId >> 6] = uint64_t(1) << (tileId & 63);
+    allowTiles(x, y, allowed.data());
+}
+
+void MapConstraints::pinTiles(const TileIdGrid& grid){
+    const cv::Size size = grid.getSize();
+    for(int y = 0; y < size.height; y++){
+        for(int x = 0; x < size.width; x++){
+            const size_t id = grid.get(x, y);
+            if(id != 0) pinTile(x, y, id - 1);
+        }
+    }
+}
+
+void MapConstraints::forbidTile(cv::Rect region, size_t tileId){
+    if(tileId >= m_adjacency.getTilesCount())
+        throw std::runtime_error("MapConstraints: wrong tile id " + std::to_string(tileId));
+
+    std::vector<uint64_t> allowed(m_adjacency.getAllTilesMask(), m_adjacency.getAllTilesMask() + m_words);
+    allowed[tileId >> 6] &= ~(uint64_t(1) << (tileId & 63));
+    allowTiles(region, allowed.data());
+}
+
+void MapConstraints::setBorderSide(uint32_t dir, const std::string& side){
+    if(dir > 3)
+        throw std::runtime_error("MapConstraints: wrong direction of border");
+    const uint32_t sideId = m_adjacency.getSideId(side);
+    if(sideId == TileAdjacency::NO_SIDE || sideId == TileAdjacency::UNKNOWN_SIDE)
+        throw std::runtime_error("MapConstraints: side \"" + side + "\" isn't used by any tile or rule");
+
+    //tiles whose side dir fits sideId
+    const uint64_t* allowed = m_adjacency.getMask(dir, sideId);
+    switch(dir){
+    case 0:
+        allowTiles(cv::Rect(0, 0, m_size.width, 1), allowed);
+        break;
+    case 1:
+        allowTiles(cv::Rect(m_size.width - 1, 0, 1, m_size.height), allowed);
+        break;
+    case 2:
+        allowTiles(cv::Rect(0, m_size.height - 1, m_size.width, 1), allowed);
+        break;
+    default:
+        allowTiles(cv::Rect(0, 0, 1, m_size.height), allowed);
+        break;
+    }
+}
@@ -0,0 +1,240 @@
+#include "../include/mapFile.h"
+#include <cstring>
+#include <climits>
+#include <stdexcept>
+
+
+namespace{
+    constexpr char MAGIC[4] = {'T', 'M', 'A', 'P'};
+    constexpr uint32_t VERSION = 1;
+
+    //encoding of chunk, it's the first byte of chunk
+    enum ChunkEncoding : uint8_t{
+        RUNS = 0,  //runs of equal cells: varint count, varint value
+        CELLS = 1  //varint value of every cell, for maps without long runs
+    };
+
+    void writeVarint(std::vector<uint8_t>& out, uint64_t value){
+        while(value >= 0x80){
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    //return false if varint doesn't end before end
+    bool readVarint(const uint8_t*& ptr, const uint8_t* end, uint64_t& value){
+        value = 0;
+        for(int shift = 0; shift < 64 && ptr < end; shift += 7){
+            const uint8_t byte = *ptr++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if(!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+MapFileWriter::MapFileWriter(const std::string& path, cv::Size size, uint64_t tileSetHash, size_t tilesCount, uint32_t rowsPerChunk)
+                            :m_file(path, std::ios::binary | std::ios::trunc), m_path(path){
+    if(!m_file)
+        throw std::runtime_error("MapFileWriter: can't open \"" + path + "\"");
+    if(size.width <= 0 || size.height <= 0)
+        throw std::runtime_error("MapFileWriter: map should have at least one cell");
+    if(rowsPerChunk == 0)
+        throw std::runtime_error("MapFileWriter: chunk should have at least one row");
+
+    std::memset(&m_header, 0, sizeof(m_header));
+    std::memcpy(m_header.magic, MAGIC, sizeof(MAGIC));
+    m_header.version = VERSION;
+    m_header.tileSetHash = tileSetHash;
+    m_header.width = size.width;
+    m_header.height = size.height;
+    m_header.tilesCount = static_cast<uint32_t>(tilesCount);
+    m_header.rowsPerChunk = rowsPerChunk;
+    m_header.chunksCount = (m_header.height + rowsPerChunk - 1) / rowsPerChunk;
+
+    //header is rewritten with offset of index in finish()
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    m_offsets.reserve(m_header.chunksCount + 1);
+    m_chunk.reserve(static_cast<size_t>(m_header.width) * rowsPerChunk);
+}
+
+MapFileWriter::~MapFileWriter(){
+    if(m_finished) return;
+    try{
+        finish();
+    }
+    catch(...){}
+}
+
+void MapFileWriter::_writeChunk(){
+    m_encoded.assign(1, RUNS);
+    for(size_t i = 0; i < m_chunk.size();){
+        size_t end = i + 1;
+        while(end < m_chunk.size() && m_chunk[end] == m_chunk[i]) end++;
+        writeVarint(m_encoded, end - i);
+        writeVarint(m_encoded, m_chunk[i]);
+        i = end;
+    }
+
+    //short runs take more space than cells themselves
+    if(m_encoded.size() > m_chunk.size() + 1){
+        m_encoded.assign(1, CELLS);
+        for(uint32_t value: m_chunk){
+            writeVarint(m_encoded, value);
+        }
+    }
+
+    m_offsets.push_back(static_cast<uint64_t>(m_file.tellp()));
+    m_file.write(reinterpret_cast<const char*>(m_encoded.data()), m_encoded.size());
+    m_chunk.clear();
+}
+
+void MapFileWriter::writeRow(const uint32_t* cells){
+    if(m_rows >= m_header.height)
+        throw std::runtime_error("MapFileWriter: all rows of \"" + m_path + "\" are already written");
+
+    for(uint32_t x = 0; x < m_header.width; x++){
+        if(cells[x] > m_header.tilesCount)
+            throw std::runtime_error("MapFileWriter: cell value is greater than count of tiles");
+    }
+    m_chunk.insert(m_chunk.end(), cells, cells + m_header.width);
+    m_rows++;
+
+    if(m_rows % m_header.rowsPerChunk == 0 || m_rows == m_header.height) _writeChunk();
+}
+
+void MapFileWriter::writeRow(const TileIdGrid& grid, int y){
+    if(grid.getSize().width != static_cast<int>(m_header.width))
+        throw std::runtime_error("MapFileWriter: width of grid isn't width of map");
+
+    m_row.resize(m_header.width);
+    for(uint32_t x = 0; x < m_header.width; x++){
+        m_row[x] = static_cast<uint32_t>(grid.get(x, y));
+    }
+    writeRow(m_row.data());
+}
+
+void MapFileWriter::writeMap(const TileIdGrid& grid){
+    if(grid.getSize() != cv::Size(m_header.width, m_header.height))
+        throw std::runtime_error("MapFileWriter: size of grid isn't size of map");
+
+    for(uint32_t y = 0; y < m_header.height; y++){
+        writeRow(grid, y);
+    }
+}
+
+void MapFileWriter::finish(){
+    if(m_finished) return;
+    m_finished = true;
+    if(m_rows != m_header.height)
+        throw std::runtime_error("MapFileWriter: only " + std::to_string(m_rows) + " rows of \"" + m_path + "\" are written");
+
+    //index starts after the end of the last chunk
+    m_offsets.push_back(static_cast<uint64_t>(m_file.tellp()));
+    m_header.indexOffset = m_offsets.back();
+    m_file.write(reinterpret_cast<const char*>(m_offsets.data()), m_offsets.size() * sizeof(uint64_t));
+
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    m_file.close();
+    if(!m_file)
+        throw std::runtime_error("MapFileWriter: can't write \"" + m_path + "\"");
+}
+
+MapFileReader::MapFileReader(const std::string& path):m_file(path){
+    if(m_file.size() < sizeof(MapFileHeader))
+        throw std::runtime_error("MapFileReader: \"" + path + "\" is too small");
+    std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+
+    if(std::memcmp(m_header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        throw std::runtime_error("MapFileReader: \"" + path + "\" isn't map file");
+    if(m_header.version != VERSION)
+        throw std::runtime_error("MapFileReader: unsupported version " + std::to_string(m_header.version) + " of \"" + path + "\"");
+    if(m_header.rowsPerChunk == 0
+      || m_header.chunksCount != (m_header.height + m_header.rowsPerChunk - 1) / m_header.rowsPerChunk
+      || m_header.indexOffset < sizeof(MapFileHeader)
+      || m_header.indexOffset > m_file.size()
+      || (m_file.size() - m_header.indexOffset) / sizeof(uint64_t) < m_header.chunksCount + 1ull)
+        throw std::runtime_error("MapFileReader: \"" + path + "\" is corrupted");
+}
+
+cv::Size MapFileReader::getSize() const noexcept{
+    return {static_cast<int>(m_header.width), static_cast<int>(m_header.height)};
+}
+
+uint64_t MapFileReader::getTileSetHash() const noexcept{
+    return m_header.tileSetHash;
+}
+
+size_t MapFileReader::getTilesCount() const noexcept{
+    return m_header.tilesCount;
+}
+
+uint64_t MapFileReader::_chunkOffset(size_t chunk) const{
+    uint64_t offset;
+    std::memcpy(&offset, m_file.data() + m_header.indexOffset + chunk * sizeof(uint64_t), sizeof(offset));
+    return offset;
+}
+
+uint32_t MapFileReader::_decodeChunk(size_t chunk, uint32_t* cells) const{
+    const uint64_t begin = _chunkOffset(chunk);
+    const uint64_t end = _chunkOffset(chunk + 1);
+    if(begin < sizeof(MapFileHeader) || begin > end || end > m_header.indexOffset)
+        throw std::runtime_error("MapFileReader: chunk " + std::to_string(chunk) + " is corrupted");
+
+    const uint32_t rows = std::min(m_header.rowsPerChunk, m_header.height - static_cast<uint32_t>(chunk) * m_header.rowsPerChunk);
+    const size_t count = static_cast<size_t>(rows) * m_header.width;
+    const uint8_t* ptr = m_file.data() + begin;
+    const uint8_t* const last = m_file.data() + end;
+
+    const std::string error = "MapFileReader: chunk " + std::to_string(chunk) + " is corrupted";
+    if(ptr == last) throw std::runtime_error(error);
+    const uint8_t encoding = *ptr++;
+    if(encoding != RUNS && encoding != CELLS) throw std::runtime_error(error);
+
+    size_t decoded = 0;
+    while(decoded < count){
+        uint64_t length = 1, value;
+        if((encoding == RUNS && !readVarint(ptr, last, length)) || !readVarint(ptr, last, value)
+          || length == 0 || length > count - decoded || value > m_header.tilesCount)
+            throw std::runtime_error(error);
+
+        std::fill(cells + decoded, cells + decoded + length, static_cast<uint32_t>(value));
+        decoded += length;
+    }
+    return rows;
+}
+
+TileIdGrid MapFileReader::read(cv::Rect rect) const{
+    if(rect.width < 0 || rect.height < 0)
+        throw std::runtime_error("MapFileReader: size of rect is negative");
+    if(static_cast<int64_t>(rect.width) * rect.height > INT_MAX)
+        throw std::runtime_error("MapFileReader: rect is too big");
+    TileIdGrid result(rect.size(), m_header.tilesCount);
+    const cv::Rect inside = rect & cv::Rect(cv::Point(0, 0), getSize());
+    if(inside.empty()) return result;
+
+    std::vector<uint32_t> cells(static_cast<size_t>(m_header.rowsPerChunk) * m_header.width);
+    const size_t firstChunk = inside.y / m_header.rowsPerChunk;
+    const size_t lastChunk = (inside.y + inside.height - 1) / m_header.rowsPerChunk;
+
+    for(size_t chunk = firstChunk; chunk <= lastChunk; chunk++){
+        const int chunkY = static_cast<int>(chunk * m_header.rowsPerChunk);
+        const int rows = static_cast<int>(_decodeChunk(chunk, cells.data()));
+
+        const int y0 = std::max(inside.y, chunkY);
+        const int y1 = std::min(inside.y + inside.height, chunkY + rows);
+        for(int y = y0; y < y1; y++){
+            const uint32_t* row = cells.data() + static_cast<size_t>(y - chunkY) * m_header.width;
+            for(int x = inside.x; x < inside.x + inside.width; x++){
+                result.set(x - rect.x, y - rect.y, row[x]);
+            }
+        }
+    }
+    return result;
+}
+
+TileIdGrid MapFileReader::read() const{
+    return read(cv::Rect(cv::Point(0, 0), getSize()));
+}
@@ -0,0 +1,49 @@
+#include "../include/mappedFile.h"
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+MappedFile::MappedFile(const std::string& path, bool copyOnWrite){
+    const int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("MappedFile: can't open \"" + path + "\"");
+
+    struct stat info;
+    if(fstat(fd, &info) != 0){
+        close(fd);
+        throw std::runtime_error("MappedFile: can't get size of \"" + path + "\"");
+    }
+    m_size = static_cast<size_t>(info.st_size);
+
+    if(m_size > 0){
+        const int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* data = mmap(nullptr, m_size, protection, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED){
+            close(fd);
+            throw std::runtime_error("MappedFile: can't map \"" + path + "\"");
+        }
+        m_data = static_cast<uint8_t*>(data);
+    }
+    //mapping stays valid after closing of file
+    close(fd);
+}
+
+MappedFile::~MappedFile(){
+    if(m_data) munmap(m_data, m_size);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+                      :m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)){}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept{
+    if(this != &other){
+        if(m_data) munmap(m_data, m_size);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
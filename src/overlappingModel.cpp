@@ -0,0 +1,145 @@
+#include "../include/overlappingModel.h"
+#include "../include/rng.h"
+#include <cstring>
+
+
+namespace{
+    uint64_t hashPixels(const uint32_t* pixels, size_t count) noexcept{
+        uint64_t hash = 0;
+        for(size_t i = 0; i < count; i++){
+            hash = splitMix64(hash ^ pixels[i]);
+        }
+        return hash;
+    }
+
+    //dst[y][x] = src[n - 1 - x][y], rotation clockwise by 90 degrees
+    void rotatePattern(const uint32_t* src, uint32_t* dst, int n){
+        for(int y = 0; y < n; y++){
+            for(int x = 0; x < n; x++){
+                dst[y * n + x] = src[(n - 1 - x) * n + y];
+            }
+        }
+    }
+
+    void mirrorPattern(const uint32_t* src, uint32_t* dst, int n){
+        for(int y = 0; y < n; y++){
+            for(int x = 0; x < n; x++){
+                dst[y * n + x] = src[y * n + n - 1 - x];
+            }
+        }
+    }
+}
+
+OverlappingModel::OverlappingModel(const cv::Mat& sample, const OverlappingConfig& config):m_config(config){
+    const int n = m_config.patternSize;
+    if(n < 2)
+        throw std::runtime_error("OverlappingModel: pattern size should be at least 2");
+    if(sample.type() != CV_8UC3 && sample.type() != CV_8UC4)
+        throw std::runtime_error("OverlappingModel: sample should be CV_8UC3 or CV_8UC4 image");
+    if(sample.cols < n || sample.rows < n)
+        throw std::runtime_error("OverlappingModel: sample is smaller than pattern");
+
+    //pack pixels, so pattern is compared and hashed as array of integers
+    const int channels = sample.channels();
+    Grid<uint32_t> pixels({sample.cols, sample.rows});
+    for(int y = 0; y < sample.rows; y++){
+        const uint8_t* row = sample.ptr(y);
+        for(int x = 0; x < sample.cols; x++){
+            const uint8_t* pix = row + x * channels;
+            const uint32_t alpha = channels == 4 ? pix[3] : 255;
+            pixels.at(x, y) = pix[0] | (pix[1] << 8) | (pix[2] << 16) | (alpha << 24);
+        }
+    }
+
+    const int maxX = m_config.periodicInput ? sample.cols : sample.cols - n + 1;
+    const int maxY = m_config.periodicInput ? sample.rows : sample.rows - n + 1;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> index; //hash of pixels -> patterns
+    std::vector<uint32_t> variants[8];
+    for(auto& variant: variants) variant.resize(n * n);
+
+    for(int y = 0; y < maxY; y++){
+        for(int x = 0; x < maxX; x++){
+            for(int py = 0; py < n; py++){
+                for(int px = 0; px < n; px++){
+                    variants[0][py * n + px] = pixels.at((x + px) % sample.cols, (y + py) % sample.rows);
+                }
+            }
+            //even variants are rotations, odd variants are their mirrors
+            if(m_config.reflections) mirrorPattern(variants[0].data(), variants[1].data(), n);
+            if(m_config.rotations){
+                for(int i = 2; i < 8; i += 2){
+                    rotatePattern(variants[i - 2].data(), variants[i].data(), n);
+                    if(m_config.reflections) mirrorPattern(variants[i].data(), variants[i + 1].data(), n);
+                }
+            }
+            for(int i = 0; i < 8; i++){
+                if((i % 2 && !m_config.reflections) || (i >= 2 && !m_config.rotations)) continue;
+                _addPattern(variants[i].data(), index);
+            }
+        }
+    }
+}
+
+void OverlappingModel::_addPattern(const uint32_t* pixels, std::unordered_map<uint64_t, std::vector<uint32_t>>& index){
+    const size_t size = static_cast<size_t>(m_config.patternSize) * m_config.patternSize;
+    auto& patterns = index[hashPixels(pixels, size)];
+    for(uint32_t pattern: patterns){
+        if(std::memcmp(m_patterns.data() + pattern * size, pixels, size * sizeof(uint32_t)) == 0){
+            m_counts[pattern]++;
+            return;
+        }
+    }
+    patterns.push_back(static_cast<uint32_t>(m_counts.size()));
+    m_patterns.insert(m_patterns.end(), pixels, pixels + size);
+    m_counts.push_back(1);
+}
+
+size_t OverlappingModel::getPatternsCount() const noexcept{
+    return m_counts.size();
+}
+
+uint32_t OverlappingModel::getPatternCount(size_t pattern) const noexcept{
+    return m_counts[pattern];
+}
+
+const uint32_t* OverlappingModel::getPattern(size_t pattern) const noexcept{
+    return m_patterns.data() + pattern * m_config.patternSize * m_config.patternSize;
+}
+
+std::string OverlappingModel::_overlapSide(size_t pattern, int x, int y, int width, int height) const{
+    const int n = m_config.patternSize;
+    const uint32_t* pixels = getPattern(pattern);
+    uint64_t hash = splitMix64(static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height));
+    for(int py = y; py < y + height; py++){
+        for(int px = x; px < x + width; px++){
+            hash = splitMix64(hash ^ pixels[py * n + px]);
+        }
+    }
+
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string side(SIDE_FEATURES, '0');
+    for(uint32_t i = 0; i < SIDE_FEATURES; i++){
+        side[i] = digits[(hash >> (i * 4)) & 15];
+    }
+    return side;
+}
+
+TileSet OverlappingModel::createTileSet() const{
+    const int n = m_config.patternSize;
+    TileSet tileSet(SIDE_FEATURES, {1, 1});
+
+    for(size_t i = 0; i < m_counts.size(); i++){
+        const uint32_t color = getPattern(i)[0];
+        TileImage img;
+        img.getImage() = cv::Mat(1, 1, CV_8UC4, cv::Scalar(color & 255, (color >> 8) & 255, (color >> 16) & 255, color >> 24));
+
+        //side of neighbour is read from other end of overlap, so equal sides mean equal overlaps
+        TileSides sides(SIDE_FEATURES,
+                        _overlapSide(i, 0, 0, n, n - 1),  //up: rows 0..N-2, bottom side of upper pattern
+                        _overlapSide(i, 1, 0, n - 1, n),  //right: columns 1..N-1
+                        _overlapSide(i, 0, 1, n, n - 1),  //bottom: rows 1..N-1
+                        _overlapSide(i, 0, 0, n - 1, n)); //left: columns 0..N-2
+        tileSet.addTile(Tile(img, sides, m_counts[i]), TileSymmetry::None);
+    }
+    return tileSet;
+}
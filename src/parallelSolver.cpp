@@ -0,0 +1,135 @@
+#include "../include/parallelSolver.h"
+#include "../include/tilesMap.h"
+#include "../include/rng.h"
+#include "../include/mapConstraints.h"
+#include <cmath>
+
+
+namespace{
+    enum SolvePhase : uint32_t{
+        REGIONS = 1,
+        VERTICAL_SEAMS,
+        HORIZONTAL_SEAMS,
+        SEAM_CROSSINGS
+    };
+}
+
+ParallelSolver::ParallelSolver(TileSet& tileSet, const ParallelConfig& config)
+                              :m_tileSet(tileSet), m_config(config), m_pool(config.threads),
+                               m_tilesCount(tileSet.getAdjacency().getTilesCount()){
+    if(m_config.seamWidth < 1)
+        throw std::runtime_error("ParallelSolver: seam width should be at least 1");
+
+    for(size_t i = 0; i < m_pool.getThreadsCount(); i++){
+        m_solvers.push_back(std::make_unique<WfcSolver>(m_tileSet, m_config.wfc));
+    }
+}
+
+size_t ParallelSolver::getThreadsCount() const noexcept{
+    return m_pool.getThreadsCount();
+}
+
+void ParallelSolver::_solveRect(TileIdGrid& map, cv::Rect rect, bool pinBorder, uint64_t seed, const MapConstraints* constraints){
+    static constexpr int dx[4] = {0, 1, 0, -1};
+    static constexpr int dy[4] = {-1, 0, 1, 0};
+    const cv::Size mapSize = map.getSize();
+    const TileAdjacency& adjacency = m_tileSet.getAdjacency();
+
+    WfcSolver& solver = *m_solvers[ThreadPool::currentWorker()];
+    solver.reset(rect.size());
+    if(constraints) solver.restrictCells(*constraints, rect.tl());
+    if(pinBorder){
+        //border cells of rect fit sides of fixed cells around it
+        for(int y = rect.y; y < rect.y + rect.height; y++){
+            for(int x = rect.x; x < rect.x + rect.width; x++){
+                for(uint32_t dir = 0; dir < 4; dir++){
+                    const int nx = x + dx[dir], ny = y + dy[dir];
+                    const bool inside = nx >= rect.x && nx < rect.x + rect.width
+                                     && ny >= rect.y && ny < rect.y + rect.height;
+                    if(inside || nx < 0 || ny < 0 || nx >= mapSize.width || ny >= mapSize.height) continue;
+
+                    const size_t id = map.get(nx, ny);
+                    if(id == 0) continue;
+                    const uint32_t side = adjacency.getTileSide(id - 1, (dir + 2) % 4);
+                    solver.restrictCell(x - rect.x, y - rect.y, adjacency.getMask(dir, side));
+                }
+            }
+        }
+    }
+    const WfcStats stats = solver.run(seed);
+
+    for(int y = rect.y; y < rect.y + rect.height; y++){
+        for(int x = rect.x; x < rect.x + rect.width; x++){
+            map.set(x, y, solver.getCell(x - rect.x, y - rect.y));
+        }
+    }
+
+    std::lock_guard lock(m_statsMutex);
+    m_stats += stats;
+}
+
+WfcStats ParallelSolver::solve(TileIdGrid& map, cv::Size sizeMap, uint64_t seed, const MapConstraints* constraints){
+    if(constraints) constraints->checkTileSet(m_tileSet);
+    map = TileIdGrid(sizeMap, m_tilesCount);
+    m_stats = {};
+    //empty map has no regions, so count of borders regionsX - 1 or regionsY - 1 can't be computed
+    if(sizeMap.width <= 0 || sizeMap.height <= 0) return m_stats;
+
+    //regions are wider than two seams, so segments of one phase are separated by crossings and don't touch
+    const int seam = m_config.seamWidth;
+    int regionSize = m_config.regionSize;
+    if(regionSize <= 0){
+        //a few regions per thread for balancing
+        const int regionsPerSide = static_cast<int>(std::ceil(std::sqrt(4.0 * m_pool.getThreadsCount())));
+        regionSize = (std::max(sizeMap.width, sizeMap.height) + regionsPerSide - 1) / regionsPerSide;
+    }
+    regionSize = std::max(regionSize, seam * 2 + 3);
+
+    const int regionsX = (sizeMap.width + regionSize - 1) / regionSize;
+    const int regionsY = (sizeMap.height + regionSize - 1) / regionSize;
+    auto seedOf = [&](uint32_t phase, size_t index){
+        return deriveSeed(seed, phase, index);
+    };
+
+    m_pool.parallelFor(regionsX * regionsY, [&](size_t i){
+        const int x = (i % regionsX) * regionSize;
+        const int y = (i / regionsX) * regionSize;
+        const cv::Rect region(x, y, std::min(regionSize, sizeMap.width - x), std::min(regionSize, sizeMap.height - y));
+        _solveRect(map, region, false, seedOf(REGIONS, i), constraints);
+    });
+
+    //seams are split by borders of regions into segments, segments of one phase don't touch each other,
+    //so they are solved in parallel: first segments of vertical seams between crossings,
+    //then segments of horizontal seams, then crossings of seams which fit segments around them
+    const int bordersX = regionsX - 1;
+    const int bordersY = regionsY - 1;
+    //cells of region i along axis without seams of its inner borders
+    auto regionSpan = [&](int i, int regions, int length){
+        const int begin = i == 0 ? 0 : i * regionSize + seam;
+        const int end = i == regions - 1 ? length : (i + 1) * regionSize - seam;
+        return std::make_pair(begin, end);
+    };
+    //cells of seam around border i along axis
+    auto seamSpan = [&](int i, int length){
+        const int border = (i + 1) * regionSize;
+        return std::make_pair(border - seam, std::min(border + seam, length));
+    };
+    auto solveSegment = [&](std::pair<int, int> spanX, std::pair<int, int> spanY, uint32_t phase, size_t i){
+        //the last region can be narrower than seam, then its segment is in crossing
+        if(spanX.first >= spanX.second || spanY.first >= spanY.second) return;
+        const cv::Rect rect(spanX.first, spanY.first, spanX.second - spanX.first, spanY.second - spanY.first);
+        _solveRect(map, rect, true, seedOf(phase, i), constraints);
+    };
+
+    m_pool.parallelFor(bordersX * regionsY, [&](size_t i){
+        solveSegment(seamSpan(i % bordersX, sizeMap.width), regionSpan(i / bordersX, regionsY, sizeMap.height), VERTICAL_SEAMS, i);
+    });
+    m_pool.parallelFor(regionsX * bordersY, [&](size_t i){
+        solveSegment(regionSpan(i % regionsX, regionsX, sizeMap.width), seamSpan(i / regionsX, sizeMap.height), HORIZONTAL_SEAMS, i);
+    });
+    m_pool.parallelFor(bordersX * bordersY, [&](size_t i){
+        solveSegment(seamSpan(i % bordersX, sizeMap.width), seamSpan(i / bordersX, sizeMap.height), SEAM_CROSSINGS, i);
+    });
+
+    return m_stats;
+}
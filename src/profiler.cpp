@@ -0,0 +1,144 @@
+#include "../include/profiler.h"
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+#ifdef WFC_ENABLE_PROFILING
+namespace{
+    std::atomic<size_t> allocations{0};
+}
+
+void* operator new(size_t size){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept{
+    std::free(ptr);
+}
+#endif
+
+Profiler::Profiler():m_origin(std::chrono::steady_clock::now()){}
+
+Profiler& Profiler::instance(){
+    static Profiler profiler;
+    return profiler;
+}
+
+bool Profiler::isEnabled() noexcept{
+#ifdef WFC_ENABLE_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* Profiler::getSectionName(ProfileSection section) noexcept{
+    static constexpr const char* names[PROFILE_SECTIONS] = {
+        "frontier", "neighbour sides", "candidates", "choice", "propagation", "rendering"
+    };
+    const size_t index = static_cast<size_t>(section);
+    return index < PROFILE_SECTIONS ? names[index] : "unknown";
+}
+
+size_t Profiler::getAllocationsCount() noexcept{
+#ifdef WFC_ENABLE_PROFILING
+    return allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+Profiler::ThreadBuffer& Profiler::_threadBuffer(){
+    //buffers are never deleted, so pointer stays valid for whole life of thread
+    thread_local ThreadBuffer* buffer = nullptr;
+    if(!buffer){
+        std::lock_guard lock(m_mutex);
+        m_buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = m_buffers.back().get();
+        buffer->thread = static_cast<uint32_t>(m_buffers.size());
+    }
+    return *buffer;
+}
+
+void Profiler::reset(){
+    std::lock_guard lock(m_mutex);
+    for(auto& buffer: m_buffers){
+        buffer->sections = {};
+        buffer->events.clear();
+    }
+    m_origin = std::chrono::steady_clock::now();
+}
+
+void Profiler::setMaxEvents(size_t maxEvents){
+    m_maxEvents = maxEvents;
+}
+
+void Profiler::record(ProfileSection section, uint64_t start, uint64_t end){
+    ThreadBuffer& buffer = _threadBuffer();
+    const uint32_t index = static_cast<uint32_t>(section);
+    buffer.sections[index].calls++;
+    buffer.sections[index].nanoseconds += end - start;
+    if(buffer.events.size() < m_maxEvents)
+        buffer.events.push_back({index, start, end - start});
+}
+
+std::array<SectionStats, PROFILE_SECTIONS> Profiler::getSections() const{
+    std::lock_guard lock(m_mutex);
+    std::array<SectionStats, PROFILE_SECTIONS> sections = {};
+    for(const auto& buffer: m_buffers){
+        for(size_t i = 0; i < PROFILE_SECTIONS; i++){
+            sections[i].calls += buffer->sections[i].calls;
+            sections[i].nanoseconds += buffer->sections[i].nanoseconds;
+        }
+    }
+    return sections;
+}
+
+void Profiler::writeTrace(const std::string& path, const GenerationStats& stats) const{
+    std::ofstream file(path, std::ios::trunc);
+    if(!file)
+        throw std::runtime_error("Profiler: can't open \"" + path + "\"");
+
+    //timestamps of trace events are microseconds, fixed notation keeps nanoseconds of long runs
+    file<<std::fixed<<std::setprecision(3);
+    file<<"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    {
+        std::lock_guard lock(m_mutex);
+        for(const auto& buffer: m_buffers){
+            for(const Event& event: buffer->events){
+                file<<(first ? "\n" : ",\n");
+                first = false;
+                file<<"{\"name\":\""<<getSectionName(static_cast<ProfileSection>(event.section))
+                    <<"\",\"cat\":\"generation\",\"ph\":\"X\",\"pid\":1,\"tid\":"<<buffer->thread
+                    <<",\"ts\":"<<event.start / 1000.0<<",\"dur\":"<<event.duration / 1000.0<<"}";
+            }
+        }
+    }
+    file<<"\n],\"otherData\":{"
+        <<"\"profiling\":"<<(isEnabled() ? "true" : "false")
+        <<",\"steps\":"<<stats.steps
+        <<",\"contradictions\":"<<stats.contradictions
+        <<",\"peakFrontier\":"<<stats.peakFrontier
+        <<",\"allocations\":"<<stats.allocations;
+    for(size_t i = 0; i < PROFILE_SECTIONS; i++){
+        const std::string name = getSectionName(static_cast<ProfileSection>(i));
+        file<<",\""<<name<<" calls\":"<<stats.sections[i].calls
+            <<",\""<<name<<" ns\":"<<stats.sections[i].nanoseconds;
+    }
+    file<<"}}\n";
+
+    file.close();
+    if(!file)
+        throw std::runtime_error("Profiler: can't write \"" + path + "\"");
+}
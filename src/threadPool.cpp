@@ -0,0 +1,131 @@
+#include "../include/threadPool.h"
+
+
+namespace{
+    thread_local size_t currentWorkerIndex = ThreadPool::NOT_WORKER;
+    thread_local const ThreadPool* currentWorkerPool = nullptr;
+}
+
+ThreadPool::ThreadPool(size_t threads){
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for(size_t i = 0; i < threads; i++){
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for(size_t i = 0; i < threads; i++){
+        m_threads.emplace_back(&ThreadPool::_workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_taskAdded.notify_all();
+    for(auto& thread: m_threads){
+        thread.join();
+    }
+}
+
+size_t ThreadPool::getThreadsCount() const noexcept{
+    return m_threads.size();
+}
+
+size_t ThreadPool::currentWorker() noexcept{
+    return currentWorkerIndex;
+}
+
+bool ThreadPool::_popTask(size_t index, std::function<void()>& task){
+    //own queue, the newest task
+    {
+        WorkerQueue& queue = *m_queues[index];
+        std::lock_guard lock(queue.mutex);
+        if(!queue.tasks.empty()){
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            m_queued--;
+            return true;
+        }
+    }
+
+    //steal the oldest task from other queues
+    for(size_t i = 1; i < m_queues.size(); i++){
+        WorkerQueue& queue = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if(!queue.tasks.empty()){
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            m_queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::_workerLoop(size_t index){
+    currentWorkerIndex = index;
+    currentWorkerPool = this;
+
+    std::function<void()> task;
+    while(true){
+        if(!_popTask(index, task)){
+            std::unique_lock lock(m_mutex);
+            m_taskAdded.wait(lock, [&]{ return m_stop || m_queued > 0; });
+            if(m_stop && m_queued == 0) return;
+            continue;
+        }
+
+        try{
+            task();
+        }
+        catch(...){
+            std::lock_guard lock(m_mutex);
+            if(!m_exception) m_exception = std::current_exception();
+        }
+        task = nullptr;
+
+        if(--m_unfinished == 0){
+            std::lock_guard lock(m_mutex);
+            m_tasksDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task){
+    //worker puts tasks to own queue, other threads spread them over all queues
+    size_t index = currentWorkerIndex;
+    if(currentWorkerPool != this || index == NOT_WORKER)
+        index = m_nextQueue++ % m_queues.size();
+
+    m_unfinished++;
+    {
+        WorkerQueue& queue = *m_queues[index];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        m_queued++;
+    }
+    {
+        //sleeping worker checks m_queued under m_mutex, so lock it to not lose notification
+        std::lock_guard lock(m_mutex);
+    }
+    m_taskAdded.notify_one();
+}
+
+void ThreadPool::wait(){
+    std::unique_lock lock(m_mutex);
+    m_tasksDone.wait(lock, [&]{ return m_unfinished == 0; });
+
+    if(m_exception){
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func){
+    for(size_t i = 0; i < count; i++){
+        submit([&func, i]{ func(i); });
+    }
+    wait();
+}
@@ -0,0 +1,152 @@
+#include "../include/tileAdjacency.h"
+#include <stdexcept>
+
+
+void TileAdjacency::build(const std::vector<std::array<std::string, 4>>& tileSides, const EdgeCompatibility& compatibility){
+    m_sideIds.clear();
+    m_sideNames.clear();
+    m_tileSides.assign(tileSides.size(), {});
+    m_tilesCount = tileSides.size();
+    m_words = (m_tilesCount + 63) / 64;
+
+    //intern all side strings
+    for(size_t i = 0; i < tileSides.size(); i++){
+        for(uint32_t j = 0; j < 4; j++){
+            auto [it, inserted] = m_sideIds.try_emplace(tileSides[i][j], static_cast<uint32_t>(m_sideNames.size()));
+            if(inserted) m_sideNames.push_back(tileSides[i][j]);
+            m_tileSides[i][j] = it->second;
+        }
+    }
+
+    //sides of rules get ids too, so sides which are known only by rules fit tiles
+    for(const auto& [first, second]: compatibility.getRules()){
+        for(const auto& side: {first, second}){
+            if(m_sideIds.try_emplace(side, static_cast<uint32_t>(m_sideNames.size())).second)
+                m_sideNames.push_back(side);
+        }
+    }
+
+    //set bit of every tile in the mask of it side
+    for(uint32_t j = 0; j < 4; j++){
+        m_masks[j].assign(m_sideNames.size() * m_words, 0);
+        for(size_t i = 0; i < m_tilesCount; i++){
+            m_masks[j][m_tileSides[i][j] * m_words + (i >> 6)] |= uint64_t(1) << (i & 63);
+        }
+    }
+
+    //mask of side is union of masks of all sides which fit it
+    bool exact = compatibility.empty();
+    for(const auto& side: m_sideNames){
+        if(EdgeCompatibility::hasWildcard(side)) exact = false;
+    }
+    if(!exact){
+        const size_t sidesCount = m_sideNames.size();
+        //fitAfter[a] - sides which fit side a from right or from below, fitBefore[b] - from left or from above
+        std::vector<std::vector<uint32_t>> fitAfter(sidesCount), fitBefore(sidesCount);
+        for(uint32_t a = 0; a < sidesCount; a++){
+            for(uint32_t b = 0; b < sidesCount; b++){
+                if(!compatibility.isCompatible(m_sideNames[a], m_sideNames[b])) continue;
+                fitAfter[a].push_back(b);
+                fitBefore[b].push_back(a);
+            }
+        }
+        for(uint32_t j = 0; j < 4; j++){
+            //neighbour is up or left of tile in directions 0 and 3, so side of neighbour is the first one
+            const auto& fitSides = j == 0 || j == 3 ? fitAfter : fitBefore;
+            std::vector<uint64_t> masks(sidesCount * m_words, 0);
+            for(uint32_t a = 0; a < sidesCount; a++){
+                for(uint32_t b: fitSides[a]){
+                    for(size_t i = 0; i < m_words; i++) masks[a * m_words + i] |= m_masks[j][b * m_words + i];
+                }
+            }
+            m_masks[j] = std::move(masks);
+        }
+    }
+
+    m_allTiles.assign(m_words, ~uint64_t(0));
+    if(m_tilesCount % 64)
+        m_allTiles.back() = (uint64_t(1) << (m_tilesCount % 64)) - 1;
+}
+
+void TileAdjacency::load(std::vector<std::string> sideNames, std::vector<std::array<uint32_t, 4>> tileSides, const uint64_t* masks){
+    m_sideNames = std::move(sideNames);
+    m_tileSides = std::move(tileSides);
+    m_tilesCount = m_tileSides.size();
+    m_words = (m_tilesCount + 63) / 64;
+
+    m_sideIds.clear();
+    for(uint32_t i = 0; i < m_sideNames.size(); i++){
+        m_sideIds.emplace(m_sideNames[i], i);
+    }
+    for(const auto& sides: m_tileSides){
+        for(uint32_t side: sides){
+            if(side >= m_sideNames.size())
+                throw std::runtime_error("TileAdjacency: wrong side id of tile");
+        }
+    }
+
+    const size_t maskWords = m_sideNames.size() * m_words;
+    for(uint32_t j = 0; j < 4; j++){
+        m_masks[j].assign(masks + j * maskWords, masks + (j + 1) * maskWords);
+    }
+
+    m_allTiles.assign(m_words, ~uint64_t(0));
+    if(m_tilesCount % 64)
+        m_allTiles.back() = (uint64_t(1) << (m_tilesCount % 64)) - 1;
+}
+
+size_t TileAdjacency::getTilesCount() const noexcept{
+    return m_tilesCount;
+}
+
+size_t TileAdjacency::getWordsCount() const noexcept{
+    return m_words;
+}
+
+size_t TileAdjacency::getSidesCount() const noexcept{
+    return m_sideNames.size();
+}
+
+uint32_t TileAdjacency::getSideId(const std::string& side) const{
+    if(side.empty()) return NO_SIDE;
+    auto it = m_sideIds.find(side);
+    if(it == m_sideIds.end()) return UNKNOWN_SIDE;
+    return it->second;
+}
+
+const std::string& TileAdjacency::getSideName(uint32_t sideId) const{
+    if(sideId >= m_sideNames.size())
+        throw std::runtime_error("TileAdjacency: wrong side id");
+    return m_sideNames[sideId];
+}
+
+const uint64_t* TileAdjacency::getAllTilesMask() const noexcept{
+    return m_allTiles.data();
+}
+
+bool TileAdjacency::getCandidates(const std::array<uint32_t, 4>& neighbourSides, uint64_t* result) const noexcept{
+    const uint64_t* masks[4];
+    int count = 0;
+    for(uint32_t j = 0; j < 4; j++){
+        if(neighbourSides[j] == UNKNOWN_SIDE){
+            for(size_t i = 0; i < m_words; i++) result[i] = 0;
+            return false;
+        }
+        if(neighbourSides[j] != NO_SIDE)
+            masks[count++] = getMask(j, neighbourSides[j]);
+    }
+
+    if(count == 0){
+        for(size_t i = 0; i < m_words; i++) result[i] = m_allTiles[i];
+        return m_tilesCount != 0;
+    }
+
+    uint64_t any = 0;
+    for(size_t i = 0; i < m_words; i++){
+        uint64_t word = masks[0][i];
+        for(int k = 1; k < count; k++) word &= masks[k][i];
+        result[i] = word;
+        any |= word;
+    }
+    return any != 0;
+}
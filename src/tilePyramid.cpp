@@ -0,0 +1,136 @@
+#include "../include/tilePyramid.h"
+#include "../include/tileRenderer.h"
+#include "../include/mapFile.h"
+#include <filesystem>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+
+
+TilePyramidWriter::TilePyramidWriter(TileRenderer& renderer, const PyramidOutput& output)
+                                    :m_renderer(renderer), m_output(output), m_pool(output.threads){
+    if(m_output.tileSize < 2 || m_output.tileSize % 2 != 0)
+        throw std::runtime_error("TilePyramidWriter: size of image tile should be even");
+    if(m_output.format != "png" && m_output.format != "webp")
+        throw std::runtime_error("TilePyramidWriter: unknown format \"" + m_output.format + "\"");
+}
+
+void TilePyramidWriter::_writeRow(int zoom, int y, const cv::Mat& band, int bandY){
+    const int size = m_output.tileSize;
+    const int half = size / 2;
+    Zoom& current = m_zooms[zoom - m_info.minZoom];
+    Zoom* lower = zoom > m_info.minZoom ? &m_zooms[zoom - 1 - m_info.minZoom] : nullptr;
+
+    const std::string zoomPath = m_output.path + "/" + std::to_string(zoom) + "/";
+    for(int x = 0; x < current.columns; x++){
+        std::filesystem::create_directories(zoomPath + std::to_string(x));
+    }
+
+    m_pool.parallelFor(current.columns, [&](size_t x){
+        //image tiles on right and bottom border of map are filled by transparent pixels
+        const int left = static_cast<int>(x) * size;
+        cv::Mat tile = cv::Mat::zeros(size, size, band.type());
+        const cv::Rect rect = cv::Rect(left, bandY, size, size) & cv::Rect(0, 0, band.cols, band.rows);
+        if(!rect.empty())
+            band(rect).copyTo(tile(cv::Rect(rect.x - left, rect.y - bandY, rect.width, rect.height)));
+
+        const std::string path = zoomPath + std::to_string(x) + "/" + std::to_string(y) + "." + m_output.format;
+        if(!cv::imwrite(path, tile))
+            throw std::runtime_error("TilePyramidWriter: can't write \"" + path + "\"");
+
+        //2x2 image tiles of this zoom are one image tile of lower zoom
+        if(lower){
+            cv::Mat target = lower->band(cv::Rect(static_cast<int>(x) * half, (y % 2) * half, half, half));
+            cv::resize(tile, target, target.size(), 0, 0, cv::INTER_AREA);
+        }
+    });
+    m_info.imagesCount += current.columns;
+
+    if(lower && (y % 2 == 1 || y == current.rows - 1)){
+        _writeRow(zoom - 1, y / 2, lower->band, 0);
+        lower->band.setTo(cv::Scalar::all(0));
+    }
+}
+
+void TilePyramidWriter::_writeViewer() const{
+    const std::string path = m_output.path + "/index.html";
+    std::ofstream file(path);
+    if(!file) throw std::runtime_error("TilePyramidWriter: can't write \"" + path + "\"");
+
+    //pixels of maxZoom are unprojected to coordinates of map, so bounds fit image on every zoom
+    file<<"<!DOCTYPE html>\n"
+        <<"<html>\n<head>\n<meta charset=\"utf-8\">\n<title>map</title>\n"
+        <<"<link rel=\"stylesheet\" href=\"https://unpkg.com/leaflet@1.9.4/dist/leaflet.css\">\n"
+        <<"<script src=\"https://unpkg.com/leaflet@1.9.4/dist/leaflet.js\"></script>\n"
+        <<"<style>html, body, #map{ height: 100%; margin: 0; background: #202020; }</style>\n"
+        <<"</head>\n<body>\n<div id=\"map\"></div>\n<script>\n"
+        <<"const minZoom = "<<m_info.minZoom<<", maxZoom = "<<m_info.maxZoom<<";\n"
+        <<"const width = "<<m_info.imageSize.width<<", height = "<<m_info.imageSize.height<<";\n"
+        <<"const map = L.map('map', {crs: L.CRS.Simple, minZoom: minZoom, maxZoom: maxZoom + 2});\n"
+        <<"const bounds = L.latLngBounds(map.unproject([0, height], maxZoom), map.unproject([width, 0], maxZoom));\n"
+        <<"L.tileLayer('{z}/{x}/{y}."<<m_output.format<<"', {\n"
+        <<"    tileSize: "<<m_output.tileSize<<", noWrap: true, bounds: bounds,\n"
+        <<"    minNativeZoom: minZoom, maxNativeZoom: maxZoom, minZoom: minZoom, maxZoom: maxZoom + 2\n"
+        <<"}).addTo(map);\n"
+        <<"map.setMaxBounds(bounds.pad(0.5));\n"
+        <<"map.fitBounds(bounds);\n"
+        <<"</script>\n</body>\n</html>\n";
+}
+
+PyramidInfo TilePyramidWriter::write(cv::Size mapSize, const CellsReader& readCells){
+    const cv::Size cellSize = m_renderer.getTileSize();
+    const int size = m_output.tileSize;
+    m_info = {};
+    m_info.imageSize = cv::Size(mapSize.width * cellSize.width, mapSize.height * cellSize.height);
+    if(m_info.imageSize.empty())
+        throw std::runtime_error("TilePyramidWriter: map is empty");
+
+    //whole image fits one image tile on zoom 0
+    const int64_t imageSide = std::max(m_info.imageSize.width, m_info.imageSize.height);
+    while((static_cast<int64_t>(size) << m_info.maxZoom) < imageSide) m_info.maxZoom++;
+    m_info.minZoom = m_output.mipmaps ? 0 : m_info.maxZoom;
+
+    m_zooms.clear();
+    for(int zoom = m_info.minZoom; zoom <= m_info.maxZoom; zoom++){
+        //pixels of maxZoom in one image tile of this zoom
+        const int64_t scaled = static_cast<int64_t>(size) << (m_info.maxZoom - zoom);
+        Zoom& current = m_zooms.emplace_back();
+        current.columns = static_cast<int>((m_info.imageSize.width + scaled - 1) / scaled);
+        current.rows = static_cast<int>((m_info.imageSize.height + scaled - 1) / scaled);
+        if(zoom < m_info.maxZoom)
+            current.band = cv::Mat::zeros(size, current.columns * size, m_renderer.getType());
+    }
+    std::filesystem::create_directories(m_output.path);
+
+    //cells which cover row of image tiles, the first and the last rows of cells can be cut by image tiles
+    cv::Mat band;
+    for(int y = 0; y < m_zooms.back().rows; y++){
+        const int top = y * size;
+        const int bottom = std::min(top + size, m_info.imageSize.height);
+        const int firstCell = top / cellSize.height;
+        const int endCell = (bottom + cellSize.height - 1) / cellSize.height;
+        m_renderer.render(readCells(cv::Rect(0, firstCell, mapSize.width, endCell - firstCell)), band);
+        _writeRow(m_info.maxZoom, y, band, top - firstCell * cellSize.height);
+    }
+
+    if(m_output.viewer) _writeViewer();
+    return m_info;
+}
+
+PyramidInfo TilePyramidWriter::write(const TileIdGrid& map){
+    const cv::Size mapSize = map.getSize();
+    return write(mapSize, [&](cv::Rect rect){
+        TileIdGrid cells(rect.size(), m_renderer.getTilesCount());
+        for(int y = 0; y < rect.height; y++){
+            for(int x = 0; x < rect.width; x++){
+                cells.set(x, y, map.get(rect.x + x, rect.y + y));
+            }
+        }
+        return cells;
+    });
+}
+
+PyramidInfo TilePyramidWriter::write(const MapFileReader& reader){
+    return write(reader.getSize(), [&](cv::Rect rect){
+        return reader.read(rect);
+    });
+}
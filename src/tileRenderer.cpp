@@ -0,0 +1,82 @@
+#include "../include/tileRenderer.h"
+#include "../include/tilesMap.h"
+#include "../include/profiler.h"
+#include <cstring>
+
+
+TileRenderer::TileRenderer(size_t threads):m_threads(threads){}
+
+void TileRenderer::build(const TileSet& tileSet, size_t tilesCount){
+    m_tileSize = tileSet.getTileSize();
+    m_tilesCount = tilesCount;
+    const cv::Mat first = tilesCount > 0 ? tileSet.getTileById(0).getImage() : cv::Mat(1, 1, CV_8UC4);
+    m_type = first.type();
+    m_rowBytes = m_tileSize.width * first.elemSize();
+    m_tileBytes = m_rowBytes * m_tileSize.height;
+
+    m_atlas.resize(m_tileBytes * m_tilesCount);
+    for(size_t i = 0; i < m_tilesCount; i++){
+        const cv::Mat& img = tileSet.getTileById(i).getImage();
+        if(img.type() != m_type || img.size() != m_tileSize)
+            throw std::runtime_error("TileRenderer: all tiles should have the same size and type");
+
+        uint8_t* dst = m_atlas.data() + i * m_tileBytes;
+        for(int y = 0; y < m_tileSize.height; y++){
+            std::memcpy(dst + y * m_rowBytes, img.ptr(y), m_rowBytes);
+        }
+    }
+}
+
+size_t TileRenderer::getTilesCount() const noexcept{
+    return m_tilesCount;
+}
+
+cv::Size TileRenderer::getTileSize() const noexcept{
+    return m_tileSize;
+}
+
+int TileRenderer::getType() const noexcept{
+    return m_type;
+}
+
+void TileRenderer::_renderRow(const TileIdGrid& map, cv::Mat& image, int y, int x0, int x1) const{
+    for(int py = 0; py < m_tileSize.height; py++){
+        uint8_t* dst = image.ptr(y * m_tileSize.height + py) + x0 * m_rowBytes;
+        const uint8_t* src = m_atlas.data() + py * m_rowBytes;
+
+        for(int x = x0; x < x1; x++, dst += m_rowBytes){
+            const size_t id = map.get(x, y);
+            if(id != 0) std::memcpy(dst, src + (id - 1) * m_tileBytes, m_rowBytes);
+            else std::memset(dst, 0, m_rowBytes);
+        }
+    }
+}
+
+void TileRenderer::renderCells(const TileIdGrid& map, cv::Mat& image, cv::Rect cells) const{
+    cells &= cv::Rect(cv::Point(0, 0), map.getSize());
+    for(int y = cells.y; y < cells.y + cells.height; y++){
+        _renderRow(map, image, y, cells.x, cells.x + cells.width);
+    }
+}
+
+void TileRenderer::render(const TileIdGrid& map, cv::Mat& image){
+    WFC_PROFILE_SCOPE(Rendering);
+    const cv::Size mapSize = map.getSize();
+    image.create(mapSize.height * m_tileSize.height, mapSize.width * m_tileSize.width, m_type);
+
+    //small maps aren't worth of waking threads
+    static constexpr size_t MIN_PARALLEL_BYTES = 1 << 20;
+    if(static_cast<size_t>(mapSize.area()) * m_tileBytes < MIN_PARALLEL_BYTES || mapSize.height < 2){
+        renderCells(map, image, cv::Rect(cv::Point(0, 0), mapSize));
+        return;
+    }
+
+    if(!m_pool) m_pool = std::make_unique<ThreadPool>(m_threads);
+    //a few bands per thread for balancing
+    const int bands = std::min<int>(mapSize.height, m_pool->getThreadsCount() * 4);
+    const int bandHeight = (mapSize.height + bands - 1) / bands;
+    m_pool->parallelFor(bands, [&](size_t i){
+        const int y = i * bandHeight;
+        renderCells(map, image, cv::Rect(0, y, mapSize.width, std::min(bandHeight, mapSize.height - y)));
+    });
+}
@@ -0,0 +1,137 @@
+#include "../include/tileSampler.h"
+#include "../include/tileAdjacency.h"
+#include <algorithm>
+#include <bit>
+
+namespace{
+    //position of n-th set bit of word, word has more than n set bits
+    size_t nthBit(uint64_t word, size_t n){
+        for(; n > 0; n--) word &= word - 1;
+        return std::countr_zero(word);
+    }
+}
+
+
+void TileSampler::build(std::vector<uint32_t> weights){
+    m_weights = std::move(weights);
+    m_totalWeight = 0;
+    for(auto weight: m_weights){
+        m_totalWeight += weight;
+    }
+
+    //Vose's alias method
+    const size_t n = m_weights.size();
+    m_aliasProbability.assign(n, 0);
+    m_alias.assign(n, 0);
+    if(m_totalWeight == 0) return;
+
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for(size_t i = 0; i < n; i++){
+        scaled[i] = static_cast<double>(m_weights[i]) * n / m_totalWeight;
+        if(scaled[i] < 1) small.push_back(i);
+        else large.push_back(i);
+    }
+    while(!small.empty() && !large.empty()){
+        const uint32_t less = small.back();
+        const uint32_t more = large.back();
+        small.pop_back();
+        m_aliasProbability[less] = scaled[less];
+        m_alias[less] = more;
+        scaled[more] = (scaled[more] + scaled[less]) - 1;
+        if(scaled[more] < 1){
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    //rest have probability 1 up to rounding error, so they point at themselves
+    for(auto i: large){
+        m_aliasProbability[i] = 1;
+        m_alias[i] = i;
+    }
+    //tile with zero chanse can be left only by rounding error, its column is given to the heaviest tile
+    const uint32_t heaviest = static_cast<uint32_t>(std::max_element(m_weights.begin(), m_weights.end()) - m_weights.begin());
+    for(auto i: small){
+        m_aliasProbability[i] = m_weights[i] ? 1 : 0;
+        m_alias[i] = m_weights[i] ? i : heaviest;
+    }
+}
+
+size_t TileSampler::getTilesCount() const noexcept{
+    return m_weights.size();
+}
+
+const uint32_t* TileSampler::getWeights() const noexcept{
+    return m_weights.data();
+}
+
+size_t TileSampler::sample(Rng& rng) const{
+    if(m_weights.empty()) return NOT_FOUND;
+    if(m_totalWeight == 0) return rng.nextBounded(m_weights.size());
+
+    const size_t i = rng.nextBounded(m_weights.size());
+    return rng.nextDouble() < m_aliasProbability[i] ? i : m_alias[i];
+}
+
+size_t TileSampler::sample(const uint64_t* mask, size_t words, Rng& rng) const{
+    //rejection from alias table of all tiles gives the same distribution as choice from mask,
+    //it takes O(1) while mask keeps most of the weight
+    static constexpr int maxRejections = 4;
+    if(m_totalWeight != 0){
+        for(int i = 0; i < maxRejections; i++){
+            const size_t id = sample(rng);
+            if(TileAdjacency::testBit(mask, id)) return id;
+        }
+    }
+
+    //weights of words of mask are summed in one pass, then the word is found by binary search
+    //over their prefix sums and only bits of this word are walked again
+    thread_local std::vector<uint64_t> wordWeights;
+    wordWeights.resize(words);
+    uint64_t totalWeight = 0;
+    size_t count = 0;
+    for(size_t i = 0; i < words; i++){
+        count += std::popcount(mask[i]);
+        for(uint64_t word = mask[i]; word; word &= word - 1){
+            totalWeight += m_weights[(i << 6) + std::countr_zero(word)];
+        }
+        wordWeights[i] = totalWeight;
+    }
+    if(count == 0) return NOT_FOUND;
+
+    if(totalWeight == 0){
+        //tiles are equiprobable, so the word is found by counts of bits
+        size_t randNum = rng.nextBounded(count);
+        for(size_t i = 0;; i++){
+            const size_t bits = std::popcount(mask[i]);
+            if(randNum < bits) return (i << 6) + nthBit(mask[i], randNum);
+            randNum -= bits;
+        }
+    }
+
+    uint64_t randNum = rng.nextBounded(totalWeight);
+    const size_t word = std::upper_bound(wordWeights.begin(), wordWeights.end(), randNum) - wordWeights.begin();
+    if(word != 0) randNum -= wordWeights[word - 1];
+    for(uint64_t bits = mask[word];; bits &= bits - 1){
+        const size_t id = (word << 6) + std::countr_zero(bits);
+        if(randNum < m_weights[id]) return id;
+        randNum -= m_weights[id];
+    }
+}
+
+size_t TileSampler::sampleIds(const size_t* ids, size_t count, Rng& rng) const{
+    if(count == 0) return NOT_FOUND;
+
+    //prefix sums of weights, so the tile is found by binary search
+    thread_local std::vector<uint64_t> prefixWeights;
+    prefixWeights.resize(count);
+    uint64_t totalWeight = 0;
+    for(size_t i = 0; i < count; i++){
+        totalWeight += m_weights[ids[i]];
+        prefixWeights[i] = totalWeight;
+    }
+    if(totalWeight == 0) return ids[rng.nextBounded(count)];
+
+    const uint64_t randNum = rng.nextBounded(totalWeight);
+    return ids[std::upper_bound(prefixWeights.begin(), prefixWeights.end(), randNum) - prefixWeights.begin()];
+}
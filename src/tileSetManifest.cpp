@@ -0,0 +1,166 @@
+#include "../include/tileSetManifest.h"
+#include "../include/tilesMap.h"
+#include "../include/threadPool.h"
+#include <fstream>
+#include <sstream>
+#include <map>
+
+
+TileSetManifest::TileSetManifest(const std::string& path):m_path(path){
+    std::ifstream file(path);
+    if(!file)
+        throw std::runtime_error("TileSetManifest: can't open \"" + path + "\"");
+
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    std::string line;
+    size_t lineNumber = 0;
+    while(std::getline(file, line)){
+        lineNumber++;
+        _parseLine(line, lineNumber, directory);
+    }
+
+    if(m_features == 0) _error(lineNumber, "\"features\" isn't set");
+    if(m_tileSize.empty()) _error(lineNumber, "\"tile_size\" isn't set");
+    if(m_tiles.empty()) _error(lineNumber, "there are no tiles");
+    for(const auto& tile: m_tiles){
+        if(tile.sides.size() != m_features * 4)
+            _error(tile.line, "tile should have " + std::to_string(m_features * 4) + " features of sides");
+    }
+}
+
+void TileSetManifest::_error(size_t lineNumber, const std::string& message) const{
+    throw std::runtime_error("TileSetManifest: \"" + m_path + "\":" + std::to_string(lineNumber) + ": " + message);
+}
+
+void TileSetManifest::_parseLine(const std::string& line, size_t lineNumber, const std::filesystem::path& directory){
+    std::istringstream stream(line.substr(0, line.find('#')));
+    std::string directive;
+    if(!(stream>>directive)) return;
+
+    if(directive == "features"){
+        int features;
+        if(!(stream>>features) || features <= 0) _error(lineNumber, "wrong count of features");
+        m_features = features;
+    }
+    else if(directive == "tile_size"){
+        if(!(stream>>m_tileSize.width>>m_tileSize.height) || m_tileSize.empty())
+            _error(lineNumber, "wrong size of tile");
+    }
+    else if(directive == "tile"){
+        TileEntry tile;
+        std::string image;
+        if(!(stream>>image>>tile.sides)) _error(lineNumber, "tile should have image and sides");
+        tile.image = directory / image;
+        tile.line = lineNumber;
+
+        std::string option;
+        while(stream>>option){
+            const size_t separator = option.find('=');
+            if(separator == std::string::npos) _error(lineNumber, "option \"" + option + "\" should be name=value");
+            const std::string name = option.substr(0, separator);
+            const std::string value = option.substr(separator + 1);
+
+            if(name == "weight"){
+                try{
+                    tile.weight = static_cast<uint32_t>(std::stoul(value));
+                }
+                catch(const std::exception&){
+                    _error(lineNumber, "wrong weight \"" + value + "\"");
+                }
+            }
+            else if(name == "background"){
+                tile.background = directory / value;
+            }
+            else if(name == "symmetry"){
+                static const std::map<std::string, TileSymmetry> symmetries = {
+                    {"X", TileSymmetry::X}, {"I", TileSymmetry::I}, {"\\", TileSymmetry::Backslash},
+                    {"L", TileSymmetry::L}, {"T", TileSymmetry::T}, {"F", TileSymmetry::F},
+                    {"rotations", TileSymmetry::Rotations}, {"none", TileSymmetry::None}
+                };
+                auto it = symmetries.find(value);
+                if(it == symmetries.end()) _error(lineNumber, "unknown symmetry \"" + value + "\"");
+                tile.symmetry = it->second;
+            }
+            else{
+                _error(lineNumber, "unknown option \"" + name + "\"");
+            }
+        }
+        m_tiles.push_back(std::move(tile));
+    }
+    else if(directive == "compatible" || directive == "connects"){
+        std::string a, b;
+        if(!(stream>>a>>b)) _error(lineNumber, "rule should have two sides");
+        if(m_features == 0) _error(lineNumber, "\"features\" should be set before rules");
+        if(a.size() != m_features || b.size() != m_features)
+            _error(lineNumber, "sides of rule should have " + std::to_string(m_features) + " features");
+        if(directive == "compatible") m_compatibility.allow(a, b);
+        else m_compatibility.allowDirected(a, b);
+    }
+    else{
+        _error(lineNumber, "unknown directive \"" + directive + "\"");
+    }
+
+    std::string rest;
+    if(stream>>rest) _error(lineNumber, "unexpected \"" + rest + "\"");
+}
+
+uint32_t TileSetManifest::getFeaturesCount() const noexcept{
+    return m_features;
+}
+
+cv::Size TileSetManifest::getTileSize() const noexcept{
+    return m_tileSize;
+}
+
+const std::vector<TileSetManifest::TileEntry>& TileSetManifest::getTiles() const noexcept{
+    return m_tiles;
+}
+
+const EdgeCompatibility& TileSetManifest::getCompatibility() const noexcept{
+    return m_compatibility;
+}
+
+TileSet TileSetManifest::createTileSet(size_t threads) const{
+    ThreadPool pool(threads);
+
+    //every background is loaded once even if many tiles use it
+    std::map<std::filesystem::path, TileImage> backgrounds;
+    for(const auto& tile: m_tiles){
+        if(!tile.background.empty()) backgrounds.emplace(tile.background, TileImage());
+    }
+    std::vector<std::map<std::filesystem::path, TileImage>::iterator> backgroundsList;
+    for(auto it = backgrounds.begin(); it != backgrounds.end(); it++){
+        backgroundsList.push_back(it);
+    }
+    pool.parallelFor(backgroundsList.size(), [&](size_t i){
+        const std::string path = backgroundsList[i]->first.string();
+        try{
+            backgroundsList[i]->second = TileImage(path);
+        }
+        catch(const std::exception&){
+            throw std::runtime_error("TileSetManifest: can't load background \"" + path + "\"");
+        }
+    });
+
+    std::vector<TileImage> images(m_tiles.size());
+    pool.parallelFor(m_tiles.size(), [&](size_t i){
+        const TileEntry& tile = m_tiles[i];
+        try{
+            if(tile.background.empty())
+                images[i] = TileImage(tile.image.string());
+            else
+                images[i] = TileImage(tile.image.string(), backgrounds.at(tile.background).getImage());
+        }
+        catch(const std::exception&){
+            _error(tile.line, "can't load image \"" + tile.image.string() + "\"");
+        }
+    });
+
+    TileSet tileSet(m_features, m_tileSize);
+    tileSet.setCompatibility(m_compatibility);
+    for(size_t i = 0; i < m_tiles.size(); i++){
+        const TileEntry& tile = m_tiles[i];
+        tileSet.addTile(Tile(images[i], TileSides(m_features, tile.sides), tile.weight), tile.symmetry);
+    }
+    return tileSet;
+}
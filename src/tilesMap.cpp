@@ -1,8 +1,72 @@
 #include "../include/tilesMap.h"
+#include <fstream>
+#include <cstring>
 
 
+namespace{
+    //FNV-1a
+    constexpr uint64_t HASH_BASIS = 0xcbf29ce484222325ULL;
+
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size) noexcept{
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for(size_t i = 0; i < size; i++){
+            hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    uint64_t hashValue(uint64_t hash, const T& value) noexcept{
+        return hashBytes(hash, &value, sizeof(value));
+    }
+
+    //layout of tile set cache file (native byte order):
+    //  header
+    //  sides: uint32 length and characters of every interned side, then first and second sides
+    //         of every directed rule of EdgeCompatibility in the same format
+    //  side ids of every tile, 4 uint32 per tile
+    //  chanse of every tile, uint32 per tile
+    //  image id of every tile, uint32 per tile
+    //  masks of TileAdjacency, 4 * sidesCount * words uint64
+    //  unique images, tiles with equal images share one image, tileBytes per image
+    //sections are aligned by CACHE_ALIGN bytes
+    struct TileSetCacheHeader{
+        char magic[4];
+        uint32_t version;
+        uint64_t hash; //TileSet::getHash() of saved tile set
+        uint32_t features;
+        uint32_t tileWidth;
+        uint32_t tileHeight;
+        uint32_t imageType;
+        uint32_t tilesCount;
+        uint32_t sidesCount;
+        uint32_t words;
+        uint32_t tileBytes;
+        uint32_t imagesCount;
+        uint32_t rulesCount; //count of rules of EdgeCompatibility
+        uint64_t sidesOffset;
+        uint64_t tileSidesOffset;
+        uint64_t chansesOffset;
+        uint64_t imageIdsOffset;
+        uint64_t masksOffset;
+        uint64_t imagesOffset;
+        uint64_t fileSize;
+    };
+    static_assert(sizeof(TileSetCacheHeader) == 112);
+
+    constexpr char CACHE_MAGIC[4] = {'T', 'S', 'E', 'T'};
+    constexpr uint32_t CACHE_VERSION = 4;
+    constexpr size_t CACHE_ALIGN = 64;
+
+    void writePadding(std::ofstream& file){
+        static const char zeros[CACHE_ALIGN] = {};
+        const size_t offset = static_cast<size_t>(file.tellp());
+        file.write(zeros, (CACHE_ALIGN - offset % CACHE_ALIGN) % CACHE_ALIGN);
+    }
+}
+
 TileImage::TileImage(const std::string& path){
-    m_img = cv::imread(std::filesystem::current_path().string() + "/" + path, CV_8UC4);
+    m_img = cv::imread((std::filesystem::current_path() / path).string(), CV_8UC4);
 
     if(m_img.empty()){
         throw std::runtime_error("Image not created");
@@ -16,7 +80,7 @@ TileImage::TileImage(const std::string& path){
 TileImage::TileImage(const std::string& path, cv::Mat background)
 {
     background.copyTo(m_img);
-    cv::Mat tmpImg = cv::imread(std::filesystem::current_path().string() + "/" + path, CV_8UC4);
+    cv::Mat tmpImg = cv::imread((std::filesystem::current_path() / path).string(), CV_8UC4);
 
     if(tmpImg.empty()){
         throw std::runtime_error("Image not created");
@@ -74,10 +138,46 @@ void Tile::createCopy(Tile& dst){
         throw std::runtime_error("Tile: createCopy: Image is empty");
 }
 
+TileImage TileImage::getTransformed(uint32_t transform) const{
+    cv::Mat source = m_img;
+    if(transform >= 4){
+        cv::Mat mirrored;
+        cv::flip(m_img, mirrored, 1);
+        source = mirrored;
+    }
+
+    //result is always new image, so image of this tile isn't changed by rotation in place
+    TileImage result;
+    switch(transform % 4){
+    case 1:
+        cv::rotate(source, result.m_img, cv::ROTATE_90_CLOCKWISE);
+        break;
+    case 2:
+        cv::rotate(source, result.m_img, cv::ROTATE_180);
+        break;
+    case 3:
+        cv::rotate(source, result.m_img, cv::ROTATE_90_COUNTERCLOCKWISE);
+        break;
+    default:
+        result.m_img = source;
+        if(transform < 4) result.m_mapping = m_mapping;
+        break;
+    }
+    return result;
+}
+
+TileImage::TileImage(cv::Mat img, std::shared_ptr<const MappedFile> mapping)
+                    :m_img(img), m_mapping(std::move(mapping)){
+}
+
 cv::Mat& TileImage::getImage(){
     return m_img;
 }
 
+const cv::Mat& TileImage::getImage() const{
+    return m_img;
+}
+
 TileSides::TileSides(){
     for(int i = 0; i<m_sides.size(); i++)
         m_sides[i] = "";
@@ -150,11 +250,17 @@ void TileSides::rotate90Deg(uint32_t n){
     }
 }
 
+void TileSides::mirror(){
+    std::reverse(m_sides[0].begin(), m_sides[0].end());
+    std::reverse(m_sides[2].begin(), m_sides[2].end());
+    std::swap(m_sides[1], m_sides[3]);
+}
+
 uint32_t TileSides::getCountFeatures() const noexcept{
     return m_n;
 }
 
-std::array<std::string, 4> TileSides::getSides() const noexcept{
+const std::array<std::string, 4>& TileSides::getSides() const noexcept{
     return m_sides;
 }
 
@@ -175,6 +281,13 @@ void Tile::rotate90Deg(uint32_t n){
     m_sides.rotate90Deg(n);
 }
 
+Tile Tile::getTransformed(uint32_t transform) const{
+    TileSides sides = m_sides;
+    if(transform >= 4) sides.mirror();
+    sides.rotate90Deg(transform % 4);
+    return Tile(m_img.getTransformed(transform), sides, m_chanse);
+}
+
 uint32_t Tile::getCountFeatures() const noexcept{
     return m_sides.getCountFeatures();
 }
@@ -183,11 +296,15 @@ uint32_t Tile::getChanse() const noexcept{
     return m_chanse;
 }
 
-decltype(std::declval<TileImage>().getImage()) Tile::getImage(){
+decltype(std::declval<TileImage&>().getImage()) Tile::getImage(){
+    return m_img.getImage();
+}
+
+decltype(std::declval<const TileImage&>().getImage()) Tile::getImage() const{
     return m_img.getImage();
 }
 
-decltype(std::declval<TileSides>().getSides()) Tile::getSides() const{
+decltype(std::declval<const TileSides&>().getSides()) Tile::getSides() const{
     return m_sides.getSides();
 }
 
@@ -205,31 +322,73 @@ bool Tile::operator!=(Tile& right) noexcept{
 TileSet::TileSet(uint32_t countFeatures, cv::Size tileSize)
                 :m_features(countFeatures), m_tileSize(tileSize){}
 
-std::vector<Tile> TileSet::_generateTiles(Tile& tile){
+std::vector<Tile> TileSet::_generateTiles(Tile& tile, TileSymmetry symmetry){
+    std::vector<uint32_t> transforms;
+    switch(symmetry){
+    case TileSymmetry::X:
+    case TileSymmetry::None:
+        transforms = {0};
+        break;
+    case TileSymmetry::I:
+    case TileSymmetry::Backslash:
+        transforms = {0, 1};
+        break;
+    case TileSymmetry::L:
+    case TileSymmetry::T:
+    case TileSymmetry::Rotations:
+        transforms = {0, 1, 2, 3};
+        break;
+    case TileSymmetry::F:
+        transforms = {0, 1, 2, 3, 4, 5, 6, 7};
+        break;
+    }
+
+    //variants are equal if their sides and images are equal, equal images are shared
     std::vector<Tile> tiles;
-    tiles.push_back(tile);
-
-    //tile.createCopy(tmpTile);
-    for(int i = 0; i<3; i++){
-        Tile tmpTile;
-        tiles.back().createCopy(tmpTile);
-        tmpTile.rotate90Deg(1);
-        tiles.push_back(tmpTile);
-    }
-
-    //check if tile have duplicate and delete it
-    for(int i = 0; i<tiles.size(); i++){
-        for(int j = i + 1; j<tiles.size(); j++){
-            if(tiles[i]==tiles[j]){
-                tiles.erase(tiles.begin() + j);
-                j--;
-            }
+    std::unordered_map<uint64_t, std::vector<size_t>> variants;
+    for(uint32_t transform: transforms){
+        Tile variant = tile.getTransformed(transform);
+        _shareImage(variant);
+
+        uint64_t hash = hashValue(HASH_BASIS, variant.getImage().data);
+        for(const auto& side: variant.getSides()){
+            hash = hashBytes(hashValue(hash, side.size()), side.data(), side.size());
+        }
+
+        bool duplicate = false;
+        for(size_t i: variants[hash]){
+            duplicate = duplicate || (tiles[i].getImage().data == variant.getImage().data
+                                      && tiles[i].getSides() == variant.getSides());
         }
+        if(duplicate) continue;
+        variants[hash].push_back(tiles.size());
+        tiles.push_back(std::move(variant));
     }
     return tiles;
 }
 
-void TileSet::addTile(Tile tile){
+void TileSet::_shareImage(Tile& tile){
+    cv::Mat& img = tile.getImage();
+    uint64_t hash = hashValue(HASH_BASIS, img.type());
+    for(int y = 0; y < img.rows; y++){
+        hash = hashBytes(hash, img.ptr(y), img.cols * img.elemSize());
+    }
+
+    auto& images = m_images[hash];
+    for(const auto& other: images){
+        bool equal = other.type() == img.type() && other.size() == img.size();
+        for(int y = 0; equal && y < img.rows; y++){
+            equal = std::memcmp(other.ptr(y), img.ptr(y), img.cols * img.elemSize()) == 0;
+        }
+        if(equal){
+            img = other;
+            return;
+        }
+    }
+    images.push_back(img);
+}
+
+void TileSet::addTile(Tile tile, TileSymmetry symmetry){
     if(m_features != tile.getCountFeatures()
       || m_tileSize != tile.getImage().size())
     {
@@ -249,36 +408,26 @@ void TileSet::addTile(Tile tile){
         }
         return;
     }
-    std::vector<Tile> newTiles = _generateTiles(tile);
+    std::vector<Tile> newTiles = _generateTiles(tile, symmetry);
     m_tiles.insert(m_tiles.end(), std::make_move_iterator(newTiles.begin()), std::make_move_iterator(newTiles.end()));
     m_sorted = false;
+    m_hashReady = false;
 }
 
 void TileSet::_sortTileSides(){
-    //clear array
-    for(int j = 0; j < m_tileSides.size(); j++){
-        m_tileSides[j].clear();
+    std::vector<std::array<std::string, 4>> sides;
+    sides.reserve(m_tiles.size());
+    for(auto& tile: m_tiles){
+        sides.push_back(tile.getSides());
     }
+    m_tileSides.build(sides, m_compatibility);
 
-    //insert all indexes of tiles by it side
-    for(size_t i = 0; i < m_tiles.size(); i++){
-        for(int j = 0; j < m_tileSides.size(); j++){
-            const std::string side = m_tiles[i].getSides()[j];
-            if(m_tileSides[j].contains(side)){
-                m_tileSides[j][side].push_back(i);
-            }
-            else{
-                m_tileSides[j].insert({ side, std::vector<size_t>{i} });
-            }
-        }
-    }
-
-    //sorting every vector in the map
-    for(int j = 0; j < m_tileSides.size(); j++){
-        for(auto& it: m_tileSides[j]){
-            std::sort(it.second.begin(), it.second.end());
-        }
+    std::vector<uint32_t> weights;
+    weights.reserve(m_tiles.size());
+    for(auto& tile: m_tiles){
+        weights.push_back(tile.getChanse());
     }
+    m_sampler.build(std::move(weights));
 
     m_sorted = true;
 }
@@ -287,50 +436,60 @@ cv::Size TileSet::getTileSize() const{
     return m_tileSize;
 }
 
-std::vector<size_t> TileSet::_getTilesIdBySides(const std::string sides[4]){
+void TileSet::setCompatibility(EdgeCompatibility compatibility){
+    m_compatibility = std::move(compatibility);
+    m_sorted = false;
+    m_hashReady = false;
+}
 
-    std::vector<size_t> tileIndxs; //todo: convert vector to something better for deletions
+const EdgeCompatibility& TileSet::getCompatibility() const noexcept{
+    return m_compatibility;
+}
 
-    //function that find common ints in tileIndxs and given vector
-    auto findCommon = [&](const std::vector<size_t>& tmpTileIndxs){
-        std::vector<size_t> newTileIndxs;
-        for(auto num:tmpTileIndxs){
-            auto it = std::lower_bound(tileIndxs.begin(), tileIndxs.end(), num);
-            if(it != tileIndxs.end() && *it == num)
-                newTileIndxs.push_back(num);
-        }
-        tileIndxs = std::move(newTileIndxs);
-    };
-    
-    int sum = 0; //sum for check if all sides == ""
-    int sizeSide = 4;
-
-    //find tileIndxs
-    for(int i = 0; i<sizeSide; i++){
-        if(tileIndxs.size() == 0){
-            if(sides[i]!=""){
-                if(m_tileSides[i].contains(sides[i]))
-                    tileIndxs = m_tileSides[i][sides[i]];
-                else return std::vector<size_t>(); //todo: maybe do something better
-            }
-            else sum++;
+uint64_t TileSet::getHash() const{
+    if(m_hashReady) return m_hash;
+    uint64_t hash = HASH_BASIS;
+    hash = hashValue(hash, m_features);
+    hash = hashValue(hash, m_tileSize.width);
+    hash = hashValue(hash, m_tileSize.height);
+    hash = hashValue(hash, static_cast<uint64_t>(m_tiles.size()));
+
+    for(const auto& tile: m_tiles){
+        for(const auto& side: tile.getSides()){
+            hash = hashValue(hash, static_cast<uint64_t>(side.size()));
+            hash = hashBytes(hash, side.data(), side.size());
         }
-        else if(sides[i]!=""){
-            if(m_tileSides[i].contains(sides[i])){
-                const std::vector<size_t>& tmpTileIndxs = m_tileSides[i][sides[i]];
-                findCommon(tmpTileIndxs);
-            }
-            else return std::vector<size_t>();
+        hash = hashValue(hash, tile.getChanse());
+
+        const cv::Mat& img = tile.getImage();
+        hash = hashValue(hash, img.type());
+        for(int y = 0; y < img.rows; y++){
+            hash = hashBytes(hash, img.ptr(y), img.cols * img.elemSize());
         }
-        else sum++;
     }
+    //hash of tile set without rules stays the same
+    for(const auto& [a, b]: m_compatibility.getRules()){
+        hash = hashValue(hash, static_cast<uint64_t>(a.size()));
+        hash = hashBytes(hash, a.data(), a.size());
+        hash = hashValue(hash, static_cast<uint64_t>(b.size()));
+        hash = hashBytes(hash, b.data(), b.size());
+    }
+    m_hash = hash;
+    m_hashReady = true;
+    return hash;
+}
 
-    //if all sides == ""
-    if(sum == sizeSide){
-        tileIndxs.resize(m_tiles.size());
-        std::iota(tileIndxs.begin(), tileIndxs.end(), 0);
+std::vector<size_t> TileSet::_getTilesIdBySides(const std::string sides[4]){
+    std::array<uint32_t, 4> sideIds;
+    for(int i = 0; i<4; i++){
+        sideIds[i] = m_tileSides.getSideId(sides[i]);
+    }
+
+    std::vector<size_t> tileIndxs;
+    std::vector<uint64_t> mask(m_tileSides.getWordsCount());
+    if(m_tileSides.getCandidates(sideIds, mask.data())){
+        TileAdjacency::forEachBit(mask.data(), mask.size(), [&](size_t id){ tileIndxs.push_back(id); });
     }
-    
     return tileIndxs;
 }
 
@@ -367,7 +526,19 @@ std::vector<size_t> TileSet::getTilesIdBySides(const std::string sides[4]){
     return _getTilesIdBySides(sides);
 }
 
-Tile TileSet::getTileById(size_t id) const{
+const TileAdjacency& TileSet::getAdjacency(){
+    if(!m_sorted) _sortTileSides();
+
+    return m_tileSides;
+}
+
+const TileSampler& TileSet::getSampler(){
+    if(!m_sorted) _sortTileSides();
+
+    return m_sampler;
+}
+
+const Tile& TileSet::getTileById(size_t id) const{
     return m_tiles[id];
 }
 
@@ -382,148 +553,501 @@ void TileSet::saveCurrentTileSet(const std::string& directory){
     }
 }
 
-std::array<std::string, 4> TileMapGenerator::_getNeighbourSides(const TileSet& tileSet, std::pair<uint32_t, uint32_t> tileCoords) const{
-    std::array<std::string, 4> result;
-    if(tileCoords.second <= 0) result[0] = "";
-    else{
-        const size_t id = m_tileMap[tileCoords.second - 1][tileCoords.first];
-        if(id == 0) result[0] = "";
-        else result[0] = tileSet.getTileById(id - 1).getSides()[2]; //2 is bottom(otherwise side)
+void TileSet::saveCache(const std::string& path){
+    const TileAdjacency& adjacency = getAdjacency();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file)
+        throw std::runtime_error("TileSet: can't open \"" + path + "\"");
+
+    TileSetCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.hash = getHash();
+    header.features = m_features;
+    header.tileWidth = m_tileSize.width;
+    header.tileHeight = m_tileSize.height;
+    header.imageType = m_tiles.empty() ? CV_8UC4 : m_tiles.front().getImage().type();
+    header.tilesCount = static_cast<uint32_t>(m_tiles.size());
+    header.sidesCount = static_cast<uint32_t>(adjacency.getSidesCount());
+    header.words = static_cast<uint32_t>(adjacency.getWordsCount());
+    header.tileBytes = static_cast<uint32_t>(m_tileSize.area() * CV_ELEM_SIZE(header.imageType));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    writePadding(file);
+    header.sidesOffset = file.tellp();
+    auto writeString = [&](const std::string& str){
+        const uint32_t length = static_cast<uint32_t>(str.size());
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(str.data(), length);
+    };
+    for(uint32_t i = 0; i < header.sidesCount; i++){
+        writeString(adjacency.getSideName(i));
+    }
+    header.rulesCount = static_cast<uint32_t>(m_compatibility.getRules().size());
+    for(const auto& [a, b]: m_compatibility.getRules()){
+        writeString(a);
+        writeString(b);
     }
 
-    if(tileCoords.first >= m_mapSize.width-1) result[1] = "";
-    else{
-        const size_t id = m_tileMap[tileCoords.second][tileCoords.first + 1];
-        if(id == 0) result[1] = "";
-        else result[1] = tileSet.getTileById(id - 1).getSides()[3]; //3 is left(otherwise side)
+    writePadding(file);
+    header.tileSidesOffset = file.tellp();
+    for(size_t i = 0; i < m_tiles.size(); i++){
+        for(uint32_t dir = 0; dir < 4; dir++){
+            const uint32_t side = adjacency.getTileSide(i, dir);
+            file.write(reinterpret_cast<const char*>(&side), sizeof(side));
+        }
     }
 
-    if(tileCoords.second >= m_mapSize.height-1) result[2] = "";
-    else{
-        const size_t id = m_tileMap[tileCoords.second + 1][tileCoords.first];
-        if(id == 0) result[2] = "";
-        else result[2] = tileSet.getTileById(id - 1).getSides()[0]; //0 is up(otherwise side)
+    writePadding(file);
+    header.chansesOffset = file.tellp();
+    for(const auto& tile: m_tiles){
+        const uint32_t chanse = tile.getChanse();
+        file.write(reinterpret_cast<const char*>(&chanse), sizeof(chanse));
     }
 
-    if(tileCoords.first <= 0) result[3] = "";
-    else{
-        const size_t id = m_tileMap[tileCoords.second][tileCoords.first - 1];
-        if(id == 0) result[3] = "";
-        else result[3] = tileSet.getTileById(id - 1).getSides()[1]; //1 is right(otherwise side)
+    //shared images are written once
+    std::vector<const cv::Mat*> images;
+    std::unordered_map<const uint8_t*, uint32_t> imageIds;
+    writePadding(file);
+    header.imageIdsOffset = file.tellp();
+    for(const auto& tile: m_tiles){
+        auto [it, inserted] = imageIds.try_emplace(tile.getImage().data, static_cast<uint32_t>(images.size()));
+        if(inserted) images.push_back(&tile.getImage());
+        file.write(reinterpret_cast<const char*>(&it->second), sizeof(it->second));
     }
-    return result;
+    header.imagesCount = static_cast<uint32_t>(images.size());
+
+    writePadding(file);
+    header.masksOffset = file.tellp();
+    for(uint32_t dir = 0; dir < 4; dir++){
+        file.write(reinterpret_cast<const char*>(adjacency.getMask(dir, 0)),
+                   static_cast<size_t>(header.sidesCount) * header.words * sizeof(uint64_t));
+    }
+
+    //every image starts on aligned offset
+    writePadding(file);
+    header.imagesOffset = file.tellp();
+    for(const cv::Mat* image: images){
+        const cv::Mat& img = *image;
+        if(img.type() != static_cast<int>(header.imageType) || img.size() != m_tileSize)
+            throw std::runtime_error("TileSet: all tiles should have the same size and type of image");
+        for(int y = 0; y < img.rows; y++){
+            file.write(reinterpret_cast<const char*>(img.ptr(y)), img.cols * img.elemSize());
+        }
+        writePadding(file);
+    }
+
+    header.fileSize = file.tellp();
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if(!file)
+        throw std::runtime_error("TileSet: can't write \"" + path + "\"");
 }
 
-void TileMapGenerator::_generateImage(TileSet& tileSet){
-    for(size_t x = 0; x<m_tileMap.size(); x++){
-        for(size_t y = 0; y<m_tileMap[x].size(); y++){
-            if(m_tileMap[x][y]!=0)
-            tileSet.getTileById(m_tileMap[x][y]-1).getImage().copyTo(m_mapImage(
-                cv::Rect(cv::Size(y*m_tileSize.height, x*m_tileSize.width), m_tileSize))
-                );
+TileSet TileSet::loadCache(const std::string& path){
+    auto cache = std::make_shared<MappedFile>(path, true);
+    const std::string error = "TileSet: cache \"" + path + "\" is corrupted";
+    if(cache->size() < sizeof(TileSetCacheHeader))
+        throw std::runtime_error(error);
+
+    TileSetCacheHeader header;
+    std::memcpy(&header, cache->data(), sizeof(header));
+    if(std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+        throw std::runtime_error("TileSet: \"" + path + "\" isn't tile set cache");
+    if(header.version != CACHE_VERSION)
+        throw std::runtime_error("TileSet: unsupported version " + std::to_string(header.version) + " of cache \"" + path + "\"");
+
+    const uint64_t tileStride = (header.tileBytes + CACHE_ALIGN - 1) / CACHE_ALIGN * CACHE_ALIGN;
+    const uint64_t masksSize = 4ull * header.sidesCount * header.words * sizeof(uint64_t);
+    if(header.fileSize != cache->size()
+      || header.words != (header.tilesCount + 63ull) / 64
+      || header.tileBytes != static_cast<uint64_t>(header.tileWidth) * header.tileHeight * CV_ELEM_SIZE(header.imageType)
+      || header.sidesOffset < sizeof(header)
+      || header.tileSidesOffset < header.sidesOffset
+      || header.chansesOffset < header.tileSidesOffset + 16ull * header.tilesCount
+      || header.imageIdsOffset < header.chansesOffset + 4ull * header.tilesCount
+      || header.masksOffset < header.imageIdsOffset + 4ull * header.tilesCount
+      || header.masksOffset % alignof(uint64_t) != 0
+      || header.imagesOffset < header.masksOffset + masksSize
+      || header.imagesOffset + tileStride * header.imagesCount > cache->size())
+        throw std::runtime_error(error);
+
+    uint8_t* const data = cache->data();
+    auto readUint32 = [&](uint64_t offset){
+        uint32_t value;
+        std::memcpy(&value, data + offset, sizeof(value));
+        return value;
+    };
+
+    uint64_t offset = header.sidesOffset;
+    auto readString = [&](){
+        if(offset + sizeof(uint32_t) > header.tileSidesOffset) throw std::runtime_error(error);
+        const uint32_t length = readUint32(offset);
+        offset += sizeof(uint32_t);
+        if(offset + length > header.tileSidesOffset) throw std::runtime_error(error);
+        std::string str(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return str;
+    };
+    std::vector<std::string> sideNames(header.sidesCount);
+    for(auto& side: sideNames){
+        side = readString();
+    }
+    EdgeCompatibility compatibility;
+    for(uint32_t i = 0; i < header.rulesCount; i++){
+        std::string first = readString();
+        compatibility.allowDirected(first, readString());
+    }
+
+    std::vector<std::array<uint32_t, 4>> tileSides(header.tilesCount);
+    std::vector<uint32_t> chanses(header.tilesCount);
+    std::vector<uint32_t> imageIds(header.tilesCount);
+    for(uint32_t i = 0; i < header.tilesCount; i++){
+        for(uint32_t dir = 0; dir < 4; dir++){
+            tileSides[i][dir] = readUint32(header.tileSidesOffset + (i * 4ull + dir) * sizeof(uint32_t));
+            if(tileSides[i][dir] >= header.sidesCount) throw std::runtime_error(error);
         }
+        chanses[i] = readUint32(header.chansesOffset + i * sizeof(uint32_t));
+        imageIds[i] = readUint32(header.imageIdsOffset + i * sizeof(uint32_t));
+        if(imageIds[i] >= header.imagesCount) throw std::runtime_error(error);
     }
+
+    TileSet tileSet(header.features, cv::Size(header.tileWidth, header.tileHeight));
+    tileSet.m_cache = cache;
+    tileSet.m_tiles.reserve(header.tilesCount);
+    //image is header of mapped pixels, mapping is copy on write, so file isn't changed by writing to image
+    std::vector<cv::Mat> images(header.imagesCount);
+    for(uint32_t i = 0; i < header.imagesCount; i++){
+        images[i] = cv::Mat(header.tileHeight, header.tileWidth, header.imageType, data + header.imagesOffset + i * tileStride);
+    }
+    for(uint32_t i = 0; i < header.tilesCount; i++){
+        const auto& sides = tileSides[i];
+        TileSides tileSidesNames(header.features, sideNames[sides[0]], sideNames[sides[1]],
+                                 sideNames[sides[2]], sideNames[sides[3]]);
+        TileImage img(images[imageIds[i]], cache);
+        tileSet.m_tiles.emplace_back(img, tileSidesNames, chanses[i]);
+    }
+
+    tileSet.m_tileSides.load(std::move(sideNames), std::move(tileSides),
+                             reinterpret_cast<const uint64_t*>(data + header.masksOffset));
+    tileSet.m_sampler.build(std::move(chanses));
+    tileSet.m_compatibility = std::move(compatibility);
+    tileSet.m_sorted = true;
+    return tileSet;
 }
 
-uint32_t TileMapGenerator::_doGenerateStep(TileSet& tileSet){
-    //take random tile from vector
-    size_t tileIndx = rand()%m_insertTilePlaces.size();
-    auto tilePlace = m_insertTilePlaces[tileIndx];
-    m_insertTilePlaces[tileIndx] = std::move(m_insertTilePlaces.back());
-    m_insertTilePlaces.pop_back();
+std::array<uint32_t, 4> TileMapGenerator::_getNeighbourSides(const TileAdjacency& adjacency, std::pair<uint32_t, uint32_t> tileCoords) const{
+    std::array<uint32_t, 4> result;
+    result.fill(TileAdjacency::NO_SIDE);
+
+    if(tileCoords.second > 0){
+        const size_t id = m_tileMap.get(tileCoords.first, tileCoords.second - 1);
+        if(id != 0) result[0] = adjacency.getTileSide(id - 1, 2); //2 is bottom(otherwise side)
+    }
 
-    //check if tile was visited, then skip it
-    //if(m_tileMap[tilePlace.second][tilePlace.first] != 0) return !m_insertTilePlaces.empty();
-    if(m_visitedMap[tilePlace.second][tilePlace.first] > 0) return (!m_insertTilePlaces.empty() ? 2 : false );
-    m_visitedMap[tilePlace.second][tilePlace.first]++;
+    if(tileCoords.first < m_mapSize.width-1){
+        const size_t id = m_tileMap.get(tileCoords.first + 1, tileCoords.second);
+        if(id != 0) result[1] = adjacency.getTileSide(id - 1, 3); //3 is left(otherwise side)
+    }
+
+    if(tileCoords.second < m_mapSize.height-1){
+        const size_t id = m_tileMap.get(tileCoords.first, tileCoords.second + 1);
+        if(id != 0) result[2] = adjacency.getTileSide(id - 1, 0); //0 is up(otherwise side)
+    }
+
+    if(tileCoords.first > 0){
+        const size_t id = m_tileMap.get(tileCoords.first - 1, tileCoords.second);
+        if(id != 0) result[3] = adjacency.getTileSide(id - 1, 1); //1 is right(otherwise side)
+    }
+    return result;
+}
+
+void TileMapGenerator::_renderDirtyCells(){
+    for(const auto& cell: m_dirtyCells){
+        m_renderer.renderCells(m_tileMap, m_mapImage, cv::Rect(cell.first, cell.second, 1, 1));
+    }
+    m_dirtyCells.clear();
+}
+
+void TileMapGenerator::_pushNeighbours(uint32_t x, uint32_t y){
+    const uint32_t width = m_mapSize.width;
+    if(y > 0 && !m_visitedMap.at(x, y - 1)) m_frontier.insert((y - 1) * width + x);
+    if(x + 1 < width && !m_visitedMap.at(x + 1, y)) m_frontier.insert(y * width + x + 1);
+    if(y + 1 < static_cast<uint32_t>(m_mapSize.height) && !m_visitedMap.at(x, y + 1)) m_frontier.insert((y + 1) * width + x);
+    if(x > 0 && !m_visitedMap.at(x - 1, y)) m_frontier.insert(y * width + x - 1);
+}
+
+bool TileMapGenerator::_doGenerateStep(TileSet& tileSet){
+    if(m_frontier.empty()) return false;
+    m_stats.steps++;
+    std::pair<uint32_t, uint32_t> tilePlace;
+    {
+        WFC_PROFILE_SCOPE(Frontier);
+        //take random cell from frontier, it's never visited
+        const uint32_t cell = m_frontier.removeAt(m_rng.nextBounded(m_frontier.size()));
+        tilePlace = {cell % m_mapSize.width, cell / m_mapSize.width};
+    }
+    m_visitedMap.at(tilePlace.first, tilePlace.second) = 1;
     
-    auto needSides = _getNeighbourSides(tileSet, tilePlace);
-    auto candidateTiles = tileSet.getTilesIdBySides(needSides.data());
+    const TileAdjacency& adjacency = tileSet.getAdjacency();
+    std::array<uint32_t, 4> needSides;
+    {
+        WFC_PROFILE_SCOPE(NeighbourSides);
+        needSides = _getNeighbourSides(adjacency, tilePlace);
+    }
 
-    //choosing tile with chanse biases 
-    if(candidateTiles.size()!=0){
-        uint32_t maxRand = 0;
-        size_t chooseId;
-        for(auto& i: candidateTiles){
-            maxRand += tileSet.getTileById(i).getChanse();
-        }
-        if(maxRand == 0) chooseId = rand()%candidateTiles.size();
-        else{
-            uint32_t randNum = rand()%maxRand;
-            chooseId = 0;
-            while(chooseId<candidateTiles.size()){
-                uint32_t chanse = tileSet.getTileById(candidateTiles[chooseId]).getChanse();
-                if(chanse <= randNum) randNum -= chanse;
-                else break;
-                chooseId++;
+    bool found;
+    {
+        WFC_PROFILE_SCOPE(Candidates);
+        found = adjacency.getCandidates(needSides, m_candidates.data());
+        if(found && m_constraints){
+            const uint64_t* allowed = m_constraints->getMask(tilePlace.first, tilePlace.second);
+            uint64_t any = 0;
+            for(size_t i = 0; i < m_candidates.size(); i++){
+                m_candidates[i] &= allowed[i];
+                any |= m_candidates[i];
             }
+            found = any != 0;
         }
-        m_tileMap[tilePlace.second][tilePlace.first] = candidateTiles[chooseId] + 1;
-        //m_tileMap[tilePlace.second][tilePlace.first] = candidateTiles[rand()%candidateTiles.size()] + 1;
+    }
+
+    //choosing tile with chanse biases 
+    if(found){
+        WFC_PROFILE_SCOPE(Choice);
+        const size_t chooseId = tileSet.getSampler().sample(m_candidates.data(), m_candidates.size(), m_rng);
+        m_tileMap.set(tilePlace.first, tilePlace.second, chooseId + 1);
+        if(m_trackDirty) m_dirtyCells.push_back(tilePlace);
+    }
+    else{
+        m_stats.contradictions++;
     }
 
     //adding tiles in the queue
-    if(tilePlace.second > 0) m_insertTilePlaces.push_back({tilePlace.first, tilePlace.second - 1});
-    if(tilePlace.first+1 < m_mapSize.width) m_insertTilePlaces.push_back({tilePlace.first + 1, tilePlace.second});
-    if(tilePlace.second+1 < m_mapSize.height) m_insertTilePlaces.push_back({tilePlace.first, tilePlace.second + 1});
-    if(tilePlace.first > 0) m_insertTilePlaces.push_back({tilePlace.first - 1, tilePlace.second});
+    {
+        WFC_PROFILE_SCOPE(Frontier);
+        _pushNeighbours(tilePlace.first, tilePlace.second);
+    }
+    m_stats.peakFrontier = std::max(m_stats.peakFrontier, m_frontier.size());
     
-    return !m_insertTilePlaces.empty();
+    return !m_frontier.empty();
 }
 
-void TileMapGenerator::_initMaps(){
-    m_mapImage = cv::Mat(m_mapSize.height * m_tileSize.height, 
-                        m_mapSize.width * m_tileSize.width,
-                        CV_8UC4,
-                        cv::Scalar(0,0,0,0)
-                    );
-    m_tileMap = std::vector<std::vector<size_t>>(
-                m_mapSize.height, std::vector<size_t>(m_mapSize.width, 0)
-                );
+void TileMapGenerator::_startStats(){
+    m_stats = {};
+    m_sectionsStart = Profiler::instance().getSections();
+    m_allocationsStart = Profiler::getAllocationsCount();
+}
+
+void TileMapGenerator::_finishStats(){
+    const auto sections = Profiler::instance().getSections();
+    for(size_t i = 0; i < PROFILE_SECTIONS; i++){
+        m_stats.sections[i].calls = sections[i].calls - m_sectionsStart[i].calls;
+        m_stats.sections[i].nanoseconds = sections[i].nanoseconds - m_sectionsStart[i].nanoseconds;
+    }
+    m_stats.allocations = Profiler::getAllocationsCount() - m_allocationsStart;
+}
+
+void TileMapGenerator::_initMaps(TileSet& tileSet){
+    const size_t tilesCount = tileSet.getAdjacency().getTilesCount();
+    const uint64_t hash = tileSet.getHash();
+    if(!m_rendererReady || m_rendererHash != hash || m_renderer.getTilesCount() != tilesCount){
+        m_renderer.build(tileSet, tilesCount);
+        m_rendererHash = hash;
+        m_rendererReady = true;
+    }
+
+    m_mapImage.release();
+    m_imageReady = false;
+    m_tileMap = TileIdGrid(m_mapSize, tilesCount);
+    m_visitedMap = Grid<uint8_t>(m_mapSize, 0);
+}
 
-    m_visitedMap = std::vector<std::vector<int>>(
-                   m_mapSize.height, std::vector<int>(m_mapSize.width, 0)
-                   );
+void TileMapGenerator::_initQueue(){
+    m_frontier.reset(m_mapSize.area());
+
+    //generation grows from pinned cells
+    if(m_constraints){
+        const size_t words = m_constraints->getWordsCount();
+        for(uint32_t y = 0; y < static_cast<uint32_t>(m_mapSize.height); y++){
+            for(uint32_t x = 0; x < static_cast<uint32_t>(m_mapSize.width); x++){
+                if(!m_constraints->isRestricted(x, y)) continue;
+                const uint64_t* mask = m_constraints->getMask(x, y);
+                if(TileAdjacency::countBits(mask, words) != 1) continue;
+
+                TileAdjacency::forEachBit(mask, words, [&](size_t id){ m_tileMap.set(x, y, id + 1); });
+                m_visitedMap.at(x, y) = 1;
+                m_frontier.erase(y * m_mapSize.width + x);
+                if(m_trackDirty) m_dirtyCells.push_back({x, y});
+                _pushNeighbours(x, y);
+            }
+        }
+    }
+
+    if(m_frontier.empty()){
+        const uint32_t startX = m_rng.nextBounded(m_mapSize.width);
+        const uint32_t startY = m_rng.nextBounded(m_mapSize.height);
+        //every cell is pinned
+        if(m_visitedMap.at(startX, startY)) return;
+        m_frontier.insert(startY * m_mapSize.width + startX);
+    }
 }
 
-void TileMapGenerator::generateMap(TileSet& tileSet, cv::Size sizeMap){
+GenerationStats TileMapGenerator::generateMap(TileSet& tileSet, cv::Size sizeMap, uint64_t seed){
+    return _generateMap(tileSet, sizeMap, seed, nullptr);
+}
+
+GenerationStats TileMapGenerator::generateMap(TileSet& tileSet, const MapConstraints& constraints, uint64_t seed){
+    return _generateMap(tileSet, constraints.getSize(), seed, &constraints);
+}
+
+GenerationStats TileMapGenerator::_generateMap(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const MapConstraints* constraints){
+    if(constraints) constraints->checkTileSet(tileSet);
+    //steps read m_constraints, it's cleared even if generation throws
+    struct ConstraintsScope{
+        const MapConstraints*& constraints;
+        ~ConstraintsScope(){ constraints = nullptr; }
+    } scope{m_constraints};
+    m_constraints = constraints;
+
+    _startStats();
     m_mapSize = sizeMap;
     m_tileSize = tileSet.getTileSize();
+    m_candidates.assign(tileSet.getAdjacency().getWordsCount(), 0);
 
-    _initMaps();
+    _initMaps(tileSet);
+    m_rng.setSeed(seed);
+    _initQueue();
 
-    m_insertTilePlaces.clear();
-    m_insertTilePlaces.reserve(m_mapSize.area());
-    m_insertTilePlaces.push_back({rand()%m_mapSize.width, rand()%m_mapSize.height});
-    
     while(_doGenerateStep(tileSet));
 
-    _generateImage(tileSet);
+    _finishStats();
+    return m_stats;
 }
 
-void TileMapGenerator::generateMap_saveSteps(TileSet& tileSet, cv::Size sizeMap, const std::string& saveDirectory){
+WfcStats TileMapGenerator::generateMapWfc(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const WfcConfig& config){
+    return _generateMapWfc(tileSet, sizeMap, seed, config, nullptr);
+}
+
+WfcStats TileMapGenerator::generateMapWfc(TileSet& tileSet, const MapConstraints& constraints, uint64_t seed, const WfcConfig& config){
+    return _generateMapWfc(tileSet, constraints.getSize(), seed, config, &constraints);
+}
+
+WfcStats TileMapGenerator::_generateMapWfc(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const WfcConfig& config, const MapConstraints* constraints){
+    if(constraints) constraints->checkTileSet(tileSet);
+    _startStats();
     m_mapSize = sizeMap;
     m_tileSize = tileSet.getTileSize();
 
-    _initMaps();
-    m_insertTilePlaces.clear();
-    m_insertTilePlaces.reserve(m_mapSize.area());
-    m_insertTilePlaces.push_back({rand()%m_mapSize.width, rand()%m_mapSize.height});
-    
-    std::filesystem::create_directories(saveDirectory);
-
-    size_t imgCount = 0;
-    while(uint32_t ret = _doGenerateStep(tileSet)){
-        if(ret != 2){
-            _generateImage(tileSet);
-            cv::imwrite(saveDirectory + "/" + std::to_string(imgCount) + ".png", getMap());
-            imgCount++;
+    _initMaps(tileSet);
+
+    WfcSolver solver(tileSet, config);
+    solver.reset(m_mapSize);
+    if(constraints) solver.restrictCells(*constraints);
+    WfcStats stats = solver.run(seed);
+
+    for(int y = 0; y<m_mapSize.height; y++){
+        for(int x = 0; x<m_mapSize.width; x++){
+            m_tileMap.set(x, y, solver.getCell(x, y));
         }
     }
 
+    m_stats.steps = stats.collapses;
+    m_stats.contradictions = stats.contradictions;
+    m_stats.peakFrontier = stats.peakFrontier;
+    _finishStats();
+    return stats;
+}
+
+WfcStats TileMapGenerator::generateMapParallel(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const ParallelConfig& config){
+    return _generateMapParallel(tileSet, sizeMap, seed, config, nullptr);
+}
+
+WfcStats TileMapGenerator::generateMapParallel(TileSet& tileSet, const MapConstraints& constraints, uint64_t seed, const ParallelConfig& config){
+    return _generateMapParallel(tileSet, constraints.getSize(), seed, config, &constraints);
+}
+
+WfcStats TileMapGenerator::_generateMapParallel(TileSet& tileSet, cv::Size sizeMap, uint64_t seed, const ParallelConfig& config, const MapConstraints* constraints){
+    if(constraints) constraints->checkTileSet(tileSet);
+    _startStats();
+    m_mapSize = sizeMap;
+    m_tileSize = tileSet.getTileSize();
+
+    _initMaps(tileSet);
+
+    ParallelSolver solver(tileSet, config);
+    WfcStats stats = solver.solve(m_tileMap, m_mapSize, seed, constraints);
+
+    m_stats.steps = stats.collapses;
+    m_stats.contradictions = stats.contradictions;
+    m_stats.peakFrontier = stats.peakFrontier;
+    _finishStats();
+    return stats;
+}
+
+void TileMapGenerator::generateMap_saveSteps(TileSet& tileSet, cv::Size sizeMap, const std::string& saveDirectory, uint64_t seed){
+    FrameOutput output;
+    output.path = saveDirectory;
+    generateMap_saveSteps(tileSet, sizeMap, output, seed);
+}
+
+void TileMapGenerator::generateMap_saveSteps(TileSet& tileSet, cv::Size sizeMap, const FrameOutput& output, uint64_t seed){
+    _startStats();
+    m_mapSize = sizeMap;
+    m_tileSize = tileSet.getTileSize();
+    m_candidates.assign(tileSet.getAdjacency().getWordsCount(), 0);
+
+    _initMaps(tileSet);
+    m_constraints = nullptr;
+    m_rng.setSeed(seed);
+    _initQueue();
+
+    //frames are repainted in place, so image exists from the first step
+    //and has type of tiles, because renderer copies rows of tiles as they are in atlas
+    m_mapImage = cv::Mat(m_mapSize.height * m_tileSize.height,
+                        m_mapSize.width * m_tileSize.width,
+                        m_renderer.getType(),
+                        cv::Scalar::all(0)
+                    );
+    FrameWriter writer(output, m_mapImage.size());
+    const size_t everySteps = std::max<size_t>(output.everySteps, 1);
+    m_dirtyCells.clear();
+    m_trackDirty = true;
+
+    size_t steps = 0;
+    while(_doGenerateStep(tileSet)){
+        if(++steps % everySteps == 0){
+            _renderDirtyCells();
+            writer.push(m_mapImage);
+        }
+    }
+    //the last step or steps after the last frame
+    if(!m_dirtyCells.empty()){
+        _renderDirtyCells();
+        writer.push(m_mapImage);
+    }
+
+    m_trackDirty = false;
+    m_imageReady = true;
+    writer.finish();
+    _finishStats();
 }
 
 cv::Mat TileMapGenerator::getMap(){
+    if(!m_imageReady){
+        m_renderer.render(m_tileMap, m_mapImage);
+        m_imageReady = true;
+    }
     return m_mapImage;
 }
 
+const TileIdGrid& TileMapGenerator::getTileMap() const{
+    return m_tileMap;
+}
+
+const GenerationStats& TileMapGenerator::getStats() const{
+    return m_stats;
+}
+
@@ -0,0 +1,455 @@
+#include "../include/wfcSolver.h"
+#include "../include/tilesMap.h"
+#include "../include/mapConstraints.h"
+#include "../include/profiler.h"
+#include <cmath>
+
+
+WfcSolver::WfcSolver(TileSet& tileSet, const WfcConfig& config)
+                    :m_adjacency(tileSet.getAdjacency()), m_sampler(tileSet.getSampler()), m_words(m_adjacency.getWordsCount()), m_config(config),
+                     m_bitOps(config.simd ? BitOps::best() : BitOps::scalar()){
+    //small tile sets are done by specialised kernels, padding would only waste memory
+    m_stride = m_words > 4 ? (m_words + BITSET_VECTOR_WORDS - 1) / BITSET_VECTOR_WORDS * BITSET_VECTOR_WORDS : m_words;
+    const size_t tilesCount = m_adjacency.getTilesCount();
+    m_weights.resize(tilesCount);
+    m_weightLogWeights.resize(tilesCount);
+    for(size_t i = 0; i < tilesCount; i++){
+        m_weights[i] = m_sampler.getWeight(i);
+        m_weightLogWeights[i] = m_weights[i] > 0 ? m_weights[i] * std::log(m_weights[i]) : 0;
+    }
+    m_allowed.resize(m_words);
+    m_removed.resize(m_words);
+    m_sideStamps.assign(m_adjacency.getSidesCount(), 0);
+
+    //the smallest kernel which fits tile set, bigger tile sets use kernel for any count of words
+    switch(m_words){
+    case 1: m_propagateKernel = &WfcSolver::_propagateKernel<1>; break;
+    case 2: m_propagateKernel = &WfcSolver::_propagateKernel<2>; break;
+    case 3: m_propagateKernel = &WfcSolver::_propagateKernel<3>; break;
+    case 4: m_propagateKernel = &WfcSolver::_propagateKernel<4>; break;
+    default: m_propagateKernel = &WfcSolver::_propagateKernel<0>; break;
+    }
+}
+
+void WfcSolver::reset(cv::Size size){
+    m_size = size;
+    const size_t cells = m_size.area();
+    const uint64_t* all = m_adjacency.getAllTilesMask();
+
+    //padding words are always zero
+    m_domains.assign(cells * m_stride, 0);
+    for(size_t i = 0; i < cells; i++){
+        std::copy(all, all + m_words, _domain(i));
+    }
+
+    double sumWeights = 0, sumWeightLogWeights = 0;
+    for(size_t i = 0; i < m_weights.size(); i++){
+        sumWeights += m_weights[i];
+        sumWeightLogWeights += m_weightLogWeights[i];
+    }
+    m_counts.assign(cells, m_adjacency.getTilesCount());
+    m_sumWeights.assign(cells, sumWeights);
+    m_sumWeightLogWeights.assign(cells, sumWeightLogWeights);
+    m_inWorklist.assign(cells, 0);
+    m_isTouched.assign(cells, 0);
+    m_worklist.clear();
+    m_trail.clear();
+    m_decisions.clear();
+    m_entropyHeap.reset(cells);
+    m_contradiction = false;
+    m_allowHoles = true;
+    m_stats = {};
+}
+
+void WfcSolver::restrictCell(uint32_t x, uint32_t y, const uint64_t* allowed){
+    const uint32_t cell = y * m_size.width + x;
+    if(m_counts[cell] == 0) return;
+    if(_constrain(cell, allowed))
+        _pushWorklist(cell);
+}
+
+void WfcSolver::pinCell(uint32_t x, uint32_t y, size_t tileId){
+    std::fill(m_allowed.begin(), m_allowed.end(), 0);
+    m_allowed[tileId >> 6] = uint64_t(1) << (tileId & 63);
+    restrictCell(x, y, m_allowed.data());
+}
+
+void WfcSolver::restrictCells(const MapConstraints& constraints, cv::Point offset){
+    //solver doesn't keep tile set for its hash, but masks of other size are never read
+    if(constraints.getWordsCount() != m_words || constraints.getTilesCount() != m_adjacency.getTilesCount())
+        throw std::runtime_error("WfcSolver: constraints were built for other tile set");
+    const cv::Rect rect = cv::Rect(offset, m_size) & cv::Rect(cv::Point(0, 0), constraints.getSize());
+    for(int y = rect.y; y < rect.y + rect.height; y++){
+        for(int x = rect.x; x < rect.x + rect.width; x++){
+            if(constraints.isRestricted(x, y))
+                restrictCell(x - offset.x, y - offset.y, constraints.getMask(x, y));
+        }
+    }
+}
+
+double WfcSolver::_entropy(uint32_t cell) const{
+    const double sumWeights = m_sumWeights[cell];
+    //all possible tiles have zero chanse, so they are equiprobable
+    //(chanses are integers, less than 0.5 is accumulated rounding error)
+    if(sumWeights < 0.5) return std::log(static_cast<double>(m_counts[cell]));
+    return std::log(sumWeights) - m_sumWeightLogWeights[cell] / sumWeights;
+}
+
+void WfcSolver::_pushEntropy(uint32_t cell){
+    if(m_counts[cell] <= 1){
+        m_entropyHeap.erase(cell);
+        return;
+    }
+    //small noise breaks ties between cells with equal entropy
+    m_entropyHeap.set(cell, _entropy(cell) + m_rng.nextDouble() * 1e-6);
+}
+
+void WfcSolver::_recount(uint32_t cell){
+    m_counts[cell] = 0;
+    m_sumWeights[cell] = 0;
+    m_sumWeightLogWeights[cell] = 0;
+    TileAdjacency::forEachBit(_domain(cell), m_words, [&](size_t id){
+        m_counts[cell]++;
+        m_sumWeights[cell] += m_weights[id];
+        m_sumWeightLogWeights[cell] += m_weightLogWeights[id];
+    });
+}
+
+template<size_t WORDS>
+void WfcSolver::_removeTiles(uint32_t cell, const uint64_t* removed){
+    TileAdjacency::forEachBit(removed, _words<WORDS>(), [&](size_t id){
+        m_counts[cell]--;
+        m_sumWeights[cell] -= m_weights[id];
+        m_sumWeightLogWeights[cell] -= m_weightLogWeights[id];
+    });
+}
+
+void WfcSolver::_saveWord(uint32_t cell, size_t word){
+    //changes before the first decision are never reverted
+    if(m_decisions.empty()) return;
+    m_trail.push_back({cell, static_cast<uint32_t>(word), m_domains[cell * m_stride + word]});
+}
+
+template<size_t WORDS>
+bool WfcSolver::_constrain(uint32_t cell, const uint64_t* allowed){
+    const size_t words = _words<WORDS>();
+    uint64_t* domain = _domain(cell);
+    //fixed count of words is kept in registers
+    uint64_t localRemoved[WORDS > 0 ? WORDS : 1];
+    uint64_t* removed = WORDS > 0 ? localRemoved : m_removed.data();
+    uint64_t anyRemoved = 0, anyLeft = 0;
+    if constexpr(WORDS == 0){
+        const uint32_t result = m_bitOps.subtract(domain, allowed, removed, words);
+        anyRemoved = result & BitOps::ANY_REMOVED;
+        anyLeft = result & BitOps::ANY_LEFT;
+    }
+    else{
+        for(size_t i = 0; i < words; i++){
+            removed[i] = domain[i] & ~allowed[i];
+            anyRemoved |= removed[i];
+            anyLeft |= domain[i] & allowed[i];
+        }
+    }
+    if(!anyRemoved) return false;
+
+    if(!anyLeft){
+        m_stats.contradictions++;
+        if(!m_allowHoles){
+            m_contradiction = true;
+            m_contradictionCell = cell;
+            return false;
+        }
+        //nothing fits, cell stays empty and doesn't constrain neighbours
+        for(size_t i = 0; i < words; i++) domain[i] = 0;
+        m_counts[cell] = 0;
+        m_entropyHeap.erase(cell);
+        m_stats.holes++;
+        return false;
+    }
+
+    for(size_t i = 0; i < words; i++){
+        if(!removed[i]) continue;
+        _saveWord(cell, i);
+        domain[i] &= allowed[i];
+    }
+    _removeTiles<WORDS>(cell, removed);
+    _pushEntropy(cell);
+    return true;
+}
+
+void WfcSolver::_pushWorklist(uint32_t cell){
+    if(m_inWorklist[cell]) return;
+    m_inWorklist[cell] = 1;
+    m_worklist.push_back(cell);
+}
+
+void WfcSolver::_propagate(){
+    WFC_PROFILE_SCOPE(Propagation);
+    (this->*m_propagateKernel)();
+}
+
+template<size_t WORDS>
+void WfcSolver::_propagateKernel(){
+    static constexpr int dx[4] = {0, 1, 0, -1};
+    static constexpr int dy[4] = {-1, 0, 1, 0};
+    const size_t words = _words<WORDS>();
+    uint64_t localDomain[WORDS > 0 ? WORDS : 1];
+    uint64_t localAllowed[WORDS > 0 ? WORDS : 1];
+    uint64_t* allowed = WORDS > 0 ? localAllowed : m_allowed.data();
+
+    while(!m_worklist.empty()){
+        const uint32_t cell = m_worklist.back();
+        m_worklist.pop_back();
+        m_inWorklist[cell] = 0;
+        if(m_counts[cell] == 0) continue;
+        //domain of cell isn't changed while its neighbours are constrained
+        const uint64_t* domain = _domain(cell);
+        if(WORDS > 0){
+            std::copy_n(domain, words, localDomain);
+            domain = localDomain;
+        }
+
+        const int x = cell % m_size.width;
+        const int y = cell / m_size.width;
+        for(uint32_t dir = 0; dir < 4; dir++){
+            const int nx = x + dx[dir], ny = y + dy[dir];
+            if(nx < 0 || ny < 0 || nx >= m_size.width || ny >= m_size.height) continue;
+            const uint32_t neighbour = ny * m_size.width + nx;
+            if(m_counts[neighbour] == 0) continue;
+
+            //neighbour can have tiles which fit to any side of possible tiles in this cell
+            std::fill_n(allowed, words, 0);
+            if(++m_stamp == 0){
+                std::fill(m_sideStamps.begin(), m_sideStamps.end(), 0);
+                m_stamp = 1;
+            }
+            const uint32_t oppositeDir = (dir + 2) % 4;
+            TileAdjacency::forEachBit(domain, words, [&](size_t id){
+                const uint32_t side = m_adjacency.getTileSide(id, dir);
+                if(m_sideStamps[side] == m_stamp) return;
+                m_sideStamps[side] = m_stamp;
+                const uint64_t* mask = m_adjacency.getMask(oppositeDir, side);
+                if constexpr(WORDS == 0) m_bitOps.orInto(allowed, mask, words);
+                else for(size_t i = 0; i < words; i++) allowed[i] |= mask[i];
+            });
+
+            if(_constrain<WORDS>(neighbour, allowed))
+                _pushWorklist(neighbour);
+
+            if(m_contradiction){
+                //cell's remaining directions aren't propagated yet
+                _pushWorklist(cell);
+                return;
+            }
+        }
+    }
+}
+
+uint32_t WfcSolver::_pickCell(){
+    WFC_PROFILE_SCOPE(Frontier);
+    m_stats.peakFrontier = std::max(m_stats.peakFrontier, m_entropyHeap.size());
+    while(!m_entropyHeap.empty()){
+        const uint32_t cell = m_entropyHeap.pop();
+        if(m_counts[cell] > 1) return cell;
+    }
+    return UINT32_MAX;
+}
+
+void WfcSolver::_collapse(uint32_t cell){
+    WFC_PROFILE_SCOPE(Choice);
+    uint64_t* domain = _domain(cell);
+    //choosing tile with chanse biases
+    const size_t chooseId = m_sampler.sample(domain, m_words, m_rng);
+
+    if(!m_allowHoles && m_config.maxBacktracks > 0){
+        _compactTrail();
+        m_decisions.push_back({cell, static_cast<uint32_t>(chooseId), m_trail.size()});
+    }
+
+    uint64_t* removed = m_removed.data();
+    for(size_t i = 0; i < m_words; i++){
+        const uint64_t bits = (i == (chooseId >> 6)) ? uint64_t(1) << (chooseId & 63) : 0;
+        removed[i] = domain[i] & ~bits;
+        if(domain[i] != bits){
+            _saveWord(cell, i);
+            domain[i] = bits;
+        }
+    }
+    _removeTiles(cell, removed);
+
+    m_stats.collapses++;
+    _pushWorklist(cell);
+}
+
+void WfcSolver::_compactTrail(){
+    //decisions older than maxBacktracks are never reverted, so drop them with their trail
+    if(m_decisions.size() < m_config.maxBacktracks * 2) return;
+
+    const size_t dropDecisions = m_decisions.size() - m_config.maxBacktracks;
+    const size_t dropTrail = m_decisions[dropDecisions].trailSize;
+    m_decisions.erase(m_decisions.begin(), m_decisions.begin() + dropDecisions);
+    m_trail.erase(m_trail.begin(), m_trail.begin() + dropTrail);
+    for(auto& decision: m_decisions){
+        decision.trailSize -= dropTrail;
+    }
+    if(m_episodeDepth != SIZE_MAX)
+        m_episodeDepth = m_episodeDepth > dropDecisions ? m_episodeDepth - dropDecisions : 0;
+}
+
+void WfcSolver::_revert(size_t trailSize){
+    while(m_trail.size() > trailSize){
+        const TrailEntry& entry = m_trail.back();
+        m_domains[entry.cell * m_stride + entry.word] = entry.bits;
+        if(!m_isTouched[entry.cell]){
+            m_isTouched[entry.cell] = 1;
+            m_touched.push_back(entry.cell);
+        }
+        m_trail.pop_back();
+    }
+
+    for(auto cell: m_touched){
+        m_isTouched[cell] = 0;
+        _recount(cell);
+        _pushEntropy(cell);
+    }
+    m_touched.clear();
+}
+
+void WfcSolver::_resetRegion(cv::Rect region){
+    static constexpr int dx[4] = {0, 1, 0, -1};
+    static constexpr int dy[4] = {-1, 0, 1, 0};
+
+    region = region & cv::Rect(0, 0, m_size.width, m_size.height);
+    for(int y = region.y; y < region.y + region.height; y++){
+        for(int x = region.x; x < region.x + region.width; x++){
+            const uint32_t cell = y * m_size.width + x;
+            std::copy_n(m_initialDomains.data() + cell * m_stride, m_words, _domain(cell));
+            _recount(cell);
+            _pushEntropy(cell);
+        }
+    }
+
+    //cells around region constrain it again
+    for(int y = region.y - 1; y <= region.y + region.height; y++){
+        for(int x = region.x - 1; x <= region.x + region.width; x++){
+            const bool inside = x >= region.x && x < region.x + region.width
+                             && y >= region.y && y < region.y + region.height;
+            if(inside || x < 0 || y < 0 || x >= m_size.width || y >= m_size.height) continue;
+            _pushWorklist(y * m_size.width + x);
+        }
+    }
+}
+
+void WfcSolver::_resolveContradiction(){
+    m_contradiction = false;
+    if(m_episodeDepth == SIZE_MAX) m_episodeDepth = m_decisions.size();
+
+    //revert the latest decision and forbid its tile
+    if(!m_decisions.empty() && m_backtracksLeft > 0){
+        m_backtracksLeft--;
+        m_stats.backtracks++;
+        for(auto cell: m_worklist) m_inWorklist[cell] = 0;
+        m_worklist.clear();
+
+        const Decision decision = m_decisions.back();
+        m_decisions.pop_back();
+        _revert(decision.trailSize);
+
+        std::copy_n(_domain(decision.cell), m_words, m_allowed.begin());
+        m_allowed[decision.tile >> 6] &= ~(uint64_t(1) << (decision.tile & 63));
+        if(_constrain(decision.cell, m_allowed.data()))
+            _pushWorklist(decision.cell);
+        return;
+    }
+
+    if(m_restartsLeft > 0){
+        m_restartsLeft--;
+        m_backtracksLeft = m_config.maxBacktracks;
+        m_episodeDepth = SIZE_MAX;
+        m_collapsesAtRestart = m_stats.collapses;
+        for(auto cell: m_worklist) m_inWorklist[cell] = 0;
+        m_worklist.clear();
+        m_trail.clear();
+        m_decisions.clear();
+
+        const int radius = m_regionRadius;
+        const bool coversMap = radius * 2 + 1 >= std::max(m_size.width, m_size.height);
+        if(m_config.restartPolicy == RestartPolicy::FullRestart || coversMap){
+            m_stats.restarts++;
+            _resetRegion(cv::Rect(0, 0, m_size.width, m_size.height));
+        }
+        else{
+            m_stats.localResolves++;
+            const int x = m_contradictionCell % m_size.width;
+            const int y = m_contradictionCell / m_size.width;
+            _resetRegion(cv::Rect(x - radius, y - radius, radius * 2 + 1, radius * 2 + 1));
+            m_regionRadius *= 2;
+        }
+        return;
+    }
+
+    //give up, all next contradictions leave empty cells
+    m_allowHoles = true;
+    m_trail.clear();
+    m_decisions.clear();
+    for(size_t i = 0; i < m_words; i++) _domain(m_contradictionCell)[i] = 0;
+    m_counts[m_contradictionCell] = 0;
+    m_entropyHeap.erase(m_contradictionCell);
+    m_stats.holes++;
+}
+
+WfcStats WfcSolver::run(uint64_t seed){
+    m_rng.setSeed(seed);
+    //entries pushed by restrictCell() have noise from previous seed
+    m_entropyHeap.clear();
+    m_backtracksLeft = m_config.maxBacktracks;
+    m_restartsLeft = m_config.maxRestarts;
+    m_regionRadius = std::max<uint32_t>(m_config.regionRadius, 1);
+    m_episodeDepth = SIZE_MAX;
+    m_collapsesAtRestart = 0;
+
+    //initial constraints can't be resolved by restart, so they leave empty cells
+    m_allowHoles = true;
+    _propagate();
+    m_allowHoles = m_config.maxBacktracks == 0 && m_config.maxRestarts == 0;
+    if(!m_allowHoles) m_initialDomains = m_domains;
+
+    for(uint32_t i = 0; i < m_counts.size(); i++){
+        _pushEntropy(i);
+    }
+
+    uint32_t cell;
+    while((cell = _pickCell()) != UINT32_MAX){
+        _collapse(cell);
+        _propagate();
+        while(m_contradiction){
+            _resolveContradiction();
+            _propagate();
+        }
+
+        //solver got deeper than contradiction, so it's resolved and budget is restored
+        if(m_decisions.size() > m_episodeDepth){
+            m_episodeDepth = SIZE_MAX;
+            m_backtracksLeft = m_config.maxBacktracks;
+        }
+        //region was solved again, so next local region starts from initial radius
+        const size_t regionSide = m_regionRadius * 2 + 1;
+        if(m_stats.collapses - m_collapsesAtRestart > regionSide * regionSide)
+            m_regionRadius = std::max<uint32_t>(m_config.regionRadius, 1);
+    }
+    return m_stats;
+}
+
+cv::Size WfcSolver::getSize() const noexcept{
+    return m_size;
+}
+
+size_t WfcSolver::getCell(uint32_t x, uint32_t y) const noexcept{
+    const uint32_t cell = y * m_size.width + x;
+    if(m_counts[cell] != 1) return 0;
+    const uint64_t* domain = m_domains.data() + cell * m_stride;
+    for(size_t i = 0; i < m_words; i++){
+        if(domain[i]) return (i << 6) + std::countr_zero(domain[i]) + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include <map>
+#include "testUtils.h"
+#include "../include/batchGenerator.h"
+
+namespace{
+    //maps by their seeds
+    std::map<uint64_t, TileIdGrid> generate(BatchGenerator& batch, cv::Size size, const std::vector<uint64_t>& seeds){
+        std::map<uint64_t, TileIdGrid> maps;
+        const BatchStats stats = batch.generate(size, seeds, [&](size_t index, uint64_t seed, const TileIdGrid& map, const WfcStats&){
+            EXPECT_EQ(seeds[index], seed);
+            maps[seed] = map;
+        });
+        EXPECT_EQ(stats.maps, seeds.size());
+        return maps;
+    }
+}
+
+TEST(BatchGenerator, MapDependsOnlyOnSeed){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const cv::Size size(24, 20);
+    BatchGenerator several(tileSet, 4);
+    BatchGenerator single(tileSet, 1);
+    const auto maps = generate(several, size, {1, 2, 3, 4, 5, 6});
+    //other order of seeds and other count of threads
+    const auto expected = generate(single, size, {6, 5, 4, 3, 2, 1});
+
+    ASSERT_EQ(maps.size(), 6u);
+    for(const auto& [seed, map]: maps){
+        SCOPED_TRACE("seed " + std::to_string(seed));
+        test::expectValidMap(tileSet, size, [&](int x, int y){ return map.get(x, y); });
+        const TileIdGrid& other = expected.at(seed);
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                ASSERT_EQ(map.get(x, y), other.get(x, y)) << "cell (" << x << ", " << y << ")";
+            }
+        }
+    }
+}
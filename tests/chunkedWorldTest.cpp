@@ -0,0 +1,77 @@
+#include "testUtils.h"
+#include "../include/chunkedWorld.h"
+
+namespace{
+    void expectEqualChunks(const TileIdGrid& chunk, const TileIdGrid& expected){
+        ASSERT_EQ(chunk.getSize(), expected.getSize());
+        for(int y = 0; y < chunk.getSize().height; y++){
+            for(int x = 0; x < chunk.getSize().width; x++){
+                ASSERT_EQ(chunk.get(x, y), expected.get(x, y)) << "cell (" << x << ", " << y << ")";
+            }
+        }
+    }
+}
+
+TEST(ChunkedWorld, ChunksDontDependOnOrder){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    //the second world keeps only one chunk, so chunks are generated again after eviction
+    ChunkedWorld ordered(tileSet, 42, 16, 64);
+    ChunkedWorld reversed(tileSet, 42, 16, 1);
+
+    std::vector<cv::Point> chunks;
+    for(int cy = -2; cy <= 1; cy++){
+        for(int cx = -2; cx <= 1; cx++){
+            chunks.emplace_back(cx, cy);
+        }
+    }
+    for(const cv::Point& chunk: chunks) ordered.getChunk(chunk.x, chunk.y);
+    for(int pass = 0; pass < 2; pass++){
+        for(auto it = chunks.rbegin(); it != chunks.rend(); ++it){
+            SCOPED_TRACE("chunk (" + std::to_string(it->x) + ", " + std::to_string(it->y) + ")");
+            const TileIdGrid expected = ordered.getChunk(it->x, it->y);
+            expectEqualChunks(reversed.getChunk(it->x, it->y), expected);
+        }
+    }
+}
+
+TEST(ChunkedWorld, SeamsAreDeterministic){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const std::vector<cv::Point> chunks = {{0, 0}, {-1, 0}, {3, -7}, {-100000, 250000}};
+    for(uint64_t seed: {1ull, 0xfedcba9876543210ull}){
+        for(const cv::Point& chunk: chunks){
+            SCOPED_TRACE("seed " + std::to_string(seed) + ", chunk (" + std::to_string(chunk.x) + ", " + std::to_string(chunk.y) + ")");
+            //neighbours of chunk are generated before it only in the second world
+            ChunkedWorld first(tileSet, seed, 12, 4);
+            ChunkedWorld second(tileSet, seed, 12, 4);
+            second.getChunk(chunk.x + 1, chunk.y);
+            second.getChunk(chunk.x, chunk.y + 1);
+            const TileIdGrid expected = first.getChunk(chunk.x, chunk.y);
+            expectEqualChunks(second.getChunk(chunk.x, chunk.y), expected);
+        }
+    }
+
+    //other seed gives other world
+    ChunkedWorld first(tileSet, 1, 12, 4);
+    ChunkedWorld second(tileSet, 2, 12, 4);
+    const TileIdGrid chunk = first.getChunk(0, 0);
+    const TileIdGrid& other = second.getChunk(0, 0);
+    size_t different = 0;
+    for(int y = 0; y < 12; y++){
+        for(int x = 0; x < 12; x++){
+            different += chunk.get(x, y) != other.get(x, y);
+        }
+    }
+    EXPECT_GT(different, 0u);
+}
+
+TEST(ChunkedWorld, SeamsFit){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const int chunkSize = 16;
+    ChunkedWorld world(tileSet, 5, chunkSize, 4);
+
+    //area of 3x3 chunks around the origin, cells on borders of chunks should fit like inside chunks
+    const int64_t origin = -chunkSize - chunkSize / 2;
+    test::expectValidMap(tileSet, {chunkSize * 3, chunkSize * 3}, [&](int x, int y){
+        return world.getCell(origin + x, origin + y);
+    });
+}
@@ -0,0 +1,136 @@
+#include <stdexcept>
+#include "testUtils.h"
+#include "../include/edgeCompatibility.h"
+#include "../include/tileAdjacency.h"
+#include "../include/mapConstraints.h"
+
+namespace{
+    //tile's side in direction dir fits neighbour's side, neighbour is the first side of rule in directions 0 and 3
+    bool fits(const EdgeCompatibility& compatibility, uint32_t dir, const std::string& tileSide, const std::string& neighbourSide){
+        return dir == 0 || dir == 3 ? compatibility.isCompatible(neighbourSide, tileSide)
+                                    : compatibility.isCompatible(tileSide, neighbourSide);
+    }
+}
+
+TEST(EdgeCompatibility, Rules){
+    EdgeCompatibility compatibility;
+    EXPECT_TRUE(compatibility.empty());
+    EXPECT_TRUE(compatibility.isCompatible("ab", "ab"));
+    EXPECT_FALSE(compatibility.isCompatible("ab", "ba"));
+
+    compatibility.allow("rd", "re");
+    EXPECT_FALSE(compatibility.empty());
+    EXPECT_TRUE(compatibility.isCompatible("rd", "re"));
+    EXPECT_TRUE(compatibility.isCompatible("re", "rd"));
+    EXPECT_FALSE(compatibility.isCompatible("rd", "gr"));
+    EXPECT_THROW(compatibility.allow("", "rd"), std::runtime_error);
+    EXPECT_THROW(compatibility.allowDirected("rd", ""), std::runtime_error);
+}
+
+TEST(EdgeCompatibility, DirectedRules){
+    EdgeCompatibility compatibility;
+    compatibility.allowDirected("rd", "en");
+    EXPECT_TRUE(compatibility.isCompatible("rd", "en"));
+    EXPECT_FALSE(compatibility.isCompatible("en", "rd"));
+    //symmetric rule is two directed rules, rule of equal sides is one
+    compatibility.allow("gr", "sd");
+    compatibility.allow("wt", "wt");
+    EXPECT_EQ(compatibility.getRules().size(), 4u);
+    EXPECT_TRUE(compatibility.isCompatible("sd", "gr"));
+}
+
+TEST(EdgeCompatibility, Wildcards){
+    EdgeCompatibility compatibility;
+    EXPECT_TRUE(compatibility.isCompatible("1*", "10"));
+    EXPECT_TRUE(compatibility.isCompatible("11", "1*"));
+    EXPECT_FALSE(compatibility.isCompatible("1*", "01"));
+    EXPECT_FALSE(compatibility.isCompatible("1*", "1"));
+
+    compatibility.allow("2*", "3*");
+    EXPECT_TRUE(compatibility.isCompatible("21", "30"));
+    EXPECT_TRUE(compatibility.isCompatible("33", "20"));
+    EXPECT_FALSE(compatibility.isCompatible("21", "13"));
+}
+
+TEST(EdgeCompatibility, CompiledIntoMasks){
+    //sides of two features, some tiles have wildcard sides
+    std::vector<std::array<std::string, 4>> tileSides;
+    const char* sides[] = {"00", "01", "10", "20", "1*", "*2"};
+    for(int i = 0; i < 36; i++){
+        tileSides.push_back({sides[i % 6], sides[i / 6 % 6], sides[(i + 2) % 6], sides[(i / 2 + 1) % 6]});
+    }
+    //sides "3*" and "55" are used only by rules
+    EdgeCompatibility compatibility;
+    compatibility.allow("2*", "00");
+    compatibility.allowDirected("01", "10");
+    compatibility.allowDirected("3*", "01");
+    compatibility.allowDirected("20", "55");
+
+    TileAdjacency adjacency;
+    adjacency.build(tileSides, compatibility);
+    EXPECT_NE(adjacency.getSideId("3*"), TileAdjacency::UNKNOWN_SIDE);
+    EXPECT_NE(adjacency.getSideId("55"), TileAdjacency::UNKNOWN_SIDE);
+    EXPECT_EQ(adjacency.getSideId("56"), TileAdjacency::UNKNOWN_SIDE);
+    for(uint32_t dir = 0; dir < 4; dir++){
+        for(uint32_t side = 0; side < adjacency.getSidesCount(); side++){
+            const uint64_t* mask = adjacency.getMask(dir, side);
+            for(size_t id = 0; id < tileSides.size(); id++){
+                EXPECT_EQ(TileAdjacency::testBit(mask, id), fits(compatibility, dir, tileSides[id][dir], adjacency.getSideName(side)))
+                    << "tile " << id << ", direction " << dir << ", side \"" << adjacency.getSideName(side) << "\"";
+            }
+        }
+    }
+}
+
+TEST(EdgeCompatibility, BorderSideOfRule){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    EdgeCompatibility compatibility;
+    compatibility.allowDirected("2", "1");
+    tileSet.setCompatibility(compatibility);
+    const TileAdjacency& adjacency = tileSet.getAdjacency();
+
+    //side "2" is only in rule, it fits up side "1" from above and nothing from below
+    MapConstraints constraints(tileSet, {5, 4});
+    constraints.setBorderSide(0, "2");
+    constraints.setBorderSide(2, "2");
+    for(int x = 0; x < 5; x++){
+        for(size_t id = 0; id < adjacency.getTilesCount(); id++){
+            EXPECT_EQ(TileAdjacency::testBit(constraints.getMask(x, 0), id), tileSet.getTileById(id).getSides()[0] == "1") << "tile " << id;
+        }
+        EXPECT_EQ(TileAdjacency::countBits(constraints.getMask(x, 3), adjacency.getWordsCount()), 0u);
+    }
+    EXPECT_THROW(constraints.setBorderSide(1, "3"), std::runtime_error);
+}
+
+TEST(EdgeCompatibility, DirectedRuleInMap){
+    //"a" can be followed by "b" to the right and below, but "b" can't be followed by "a"
+    TileSet tileSet = test::makeTileSet({{"aaaa", 1}, {"bbbb", 1}});
+    EdgeCompatibility compatibility;
+    compatibility.allowDirected("a", "b");
+    tileSet.setCompatibility(compatibility);
+
+    for(uint64_t seed: {1, 2, 3}){
+        TileMapGenerator generator;
+        const cv::Size size(20, 20);
+        generator.generateMapWfc(tileSet, size, seed);
+        const TileIdGrid& map = generator.getTileMap();
+        auto side = [&](int x, int y, uint32_t dir){
+            return tileSet.getTileById(map.get(x, y) - 1).getSides()[dir];
+        };
+        size_t changes = 0;
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                ASSERT_NE(map.get(x, y), 0u);
+                if(x + 1 < size.width){
+                    EXPECT_TRUE(compatibility.isCompatible(side(x, y, 1), side(x + 1, y, 3))) << "cells (" << x << ", " << y << ") and right";
+                    changes += side(x, y, 1) != side(x + 1, y, 3);
+                }
+                if(y + 1 < size.height){
+                    EXPECT_TRUE(compatibility.isCompatible(side(x, y, 2), side(x, y + 1, 0))) << "cells (" << x << ", " << y << ") and below";
+                    changes += side(x, y, 2) != side(x, y + 1, 0);
+                }
+            }
+        }
+        EXPECT_GT(changes, 0u) << "seed " << seed;
+    }
+}
@@ -0,0 +1,129 @@
+#include <stdexcept>
+#include "testUtils.h"
+#include "../include/mapConstraints.h"
+
+namespace{
+    size_t findTile(TileSet& tileSet, const std::array<std::string, 4>& sides){
+        for(size_t id = 0; id < tileSet.getAdjacency().getTilesCount(); id++){
+            if(tileSet.getTileById(id).getSides() == sides) return id;
+        }
+        ADD_FAILURE() << "there is no tile with sides";
+        return 0;
+    }
+
+    //solvers which respect constraints, maps of all of them are checked
+    template<typename Check>
+    void forEachSolver(TileSet& tileSet, const MapConstraints& constraints, Check&& check){
+        ParallelConfig parallel;
+        parallel.threads = 2;
+        parallel.regionSize = 8;
+        parallel.seamWidth = 2;
+        for(uint64_t seed: {1, 2}){
+            TileMapGenerator generator;
+            generator.generateMapWfc(tileSet, constraints, seed);
+            SCOPED_TRACE("wfc, seed " + std::to_string(seed));
+            check(generator.getTileMap());
+        }
+        for(uint64_t seed: {1, 2}){
+            TileMapGenerator generator;
+            generator.generateMapParallel(tileSet, constraints, seed, parallel);
+            SCOPED_TRACE("parallel, seed " + std::to_string(seed));
+            check(generator.getTileMap());
+        }
+    }
+}
+
+TEST(MapConstraints, PinnedTiles){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const cv::Size size(30, 25);
+    MapConstraints constraints(tileSet, size);
+    const std::vector<std::pair<cv::Point, size_t>> pins = {
+        {{0, 0}, findTile(tileSet, {"1", "1", "1", "1"})},
+        {{7, 8}, findTile(tileSet, {"0", "0", "1", "0"})},
+        {{8, 8}, findTile(tileSet, {"0", "1", "1", "0"})},
+        {{29, 24}, findTile(tileSet, {"1", "0", "1", "0"})}
+    };
+    for(const auto& [cell, id]: pins) constraints.pinTile(cell.x, cell.y, id);
+
+    forEachSolver(tileSet, constraints, [&](const TileIdGrid& map){
+        for(const auto& [cell, id]: pins){
+            EXPECT_EQ(map.get(cell.x, cell.y), id + 1) << "cell (" << cell.x << ", " << cell.y << ")";
+        }
+        test::expectValidMap(tileSet, size, [&](int x, int y){ return map.get(x, y); });
+    });
+}
+
+TEST(MapConstraints, ForbiddenTiles){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const cv::Size size(30, 25);
+    MapConstraints constraints(tileSet, size);
+    //crossings are forbidden everywhere and empty tiles in the left half
+    const size_t crossing = findTile(tileSet, {"1", "1", "1", "1"});
+    const size_t empty = findTile(tileSet, {"0", "0", "0", "0"});
+    constraints.forbidTile(cv::Rect(cv::Point(0, 0), size), crossing);
+    constraints.forbidTile(cv::Rect(0, 0, size.width / 2, size.height), empty);
+
+    forEachSolver(tileSet, constraints, [&](const TileIdGrid& map){
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                ASSERT_NE(map.get(x, y), crossing + 1) << "cell (" << x << ", " << y << ")";
+                if(x < size.width / 2) ASSERT_NE(map.get(x, y), empty + 1) << "cell (" << x << ", " << y << ")";
+            }
+        }
+        test::expectValidMap(tileSet, size, [&](int x, int y){ return map.get(x, y); });
+    });
+}
+
+TEST(MapConstraints, BorderSides){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const cv::Size size(20, 16);
+    MapConstraints constraints(tileSet, size);
+    constraints.setBorderSide(0, "1");
+    for(uint32_t dir = 1; dir < 4; dir++) constraints.setBorderSide(dir, "0");
+
+    forEachSolver(tileSet, constraints, [&](const TileIdGrid& map){
+        test::expectValidMap(tileSet, size, [&](int x, int y){ return map.get(x, y); });
+        for(int x = 0; x < size.width; x++){
+            EXPECT_EQ(tileSet.getTileById(map.get(x, 0) - 1).getSides()[0], "1");
+            EXPECT_EQ(tileSet.getTileById(map.get(x, size.height - 1) - 1).getSides()[2], "0");
+        }
+        for(int y = 0; y < size.height; y++){
+            EXPECT_EQ(tileSet.getTileById(map.get(0, y) - 1).getSides()[3], "0");
+            EXPECT_EQ(tileSet.getTileById(map.get(size.width - 1, y) - 1).getSides()[1], "0");
+        }
+    });
+}
+
+TEST(MapConstraints, WrongArguments){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    MapConstraints constraints(tileSet, {10, 10});
+    EXPECT_THROW(constraints.pinTile(10, 0, 0), std::runtime_error);
+    EXPECT_THROW(constraints.pinTile(0, 0, tileSet.getAdjacency().getTilesCount()), std::runtime_error);
+    EXPECT_THROW(constraints.setBorderSide(4, "0"), std::runtime_error);
+    EXPECT_THROW(constraints.setBorderSide(0, "2"), std::runtime_error);
+}
+
+TEST(MapConstraints, OtherTileSetIsRejected){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    MapConstraints constraints(tileSet, {10, 10});
+    constraints.pinTile(0, 0, 0);
+    EXPECT_NO_THROW(constraints.checkTileSet(tileSet));
+
+    //the same count of tiles, but other sides
+    TileSet other = test::makeTileSet(test::SET_1);
+    ASSERT_EQ(other.getAdjacency().getTilesCount(), tileSet.getAdjacency().getTilesCount());
+    TileMapGenerator generator;
+    EXPECT_THROW(generator.generateMap(other, constraints), std::runtime_error);
+    EXPECT_THROW(generator.generateMapWfc(other, constraints), std::runtime_error);
+    EXPECT_THROW(generator.generateMapParallel(other, constraints), std::runtime_error);
+
+    //solver has no tile set hash, but other count of tiles is found
+    TileSet small = test::makeTileSet(test::LOOPS);
+    WfcSolver solver(small);
+    solver.reset({10, 10});
+    EXPECT_THROW(solver.restrictCells(constraints), std::runtime_error);
+
+    //generator is usable after rejected constraints
+    generator.generateMap(tileSet, {10, 10});
+    test::expectValidMap(tileSet, {10, 10}, [&](int x, int y){ return generator.getTileMap().get(x, y); });
+}
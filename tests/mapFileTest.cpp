@@ -0,0 +1,70 @@
+#include <random>
+#include <stdexcept>
+#include "testUtils.h"
+#include "../include/mapFile.h"
+
+namespace{
+    //map with random cells, tilesCount > 255 so cells take 2 bytes
+    TileIdGrid randomMap(cv::Size size, size_t tilesCount, uint32_t seed){
+        TileIdGrid map(size, tilesCount);
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<size_t> cell(0, tilesCount);
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                map.set(x, y, cell(rng));
+            }
+        }
+        return map;
+    }
+
+    void writeMap(const std::string& path, const TileIdGrid& map, uint64_t hash, size_t tilesCount){
+        //rows per chunk doesn't divide height, so the last chunk is shorter
+        MapFileWriter writer(path, map.getSize(), hash, tilesCount, 7);
+        writer.writeMap(map);
+        writer.finish();
+    }
+}
+
+TEST(MapFile, RoundTrip){
+    const size_t tilesCount = 300;
+    const TileIdGrid map = randomMap({45, 38}, tilesCount, 1);
+    test::TempFile file("roundTrip.map");
+    writeMap(file.getPath(), map, 0x1234567890abcdefull, tilesCount);
+
+    MapFileReader reader(file.getPath());
+    EXPECT_EQ(reader.getSize(), map.getSize());
+    EXPECT_EQ(reader.getTileSetHash(), 0x1234567890abcdefull);
+    EXPECT_EQ(reader.getTilesCount(), tilesCount);
+
+    const TileIdGrid read = reader.read();
+    ASSERT_EQ(read.getSize(), map.getSize());
+    for(int y = 0; y < map.getSize().height; y++){
+        for(int x = 0; x < map.getSize().width; x++){
+            ASSERT_EQ(read.get(x, y), map.get(x, y)) << "cell (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(MapFile, ReadRect){
+    const size_t tilesCount = 300;
+    const TileIdGrid map = randomMap({45, 38}, tilesCount, 2);
+    test::TempFile file("readRect.map");
+    writeMap(file.getPath(), map, 0, tilesCount);
+    MapFileReader reader(file.getPath());
+
+    //rect crosses chunks of rows and goes out of map, cells out of map are empty
+    for(const cv::Rect rect: {cv::Rect(5, 3, 20, 11), cv::Rect(40, 30, 10, 10), cv::Rect(-3, -2, 6, 5)}){
+        const TileIdGrid read = reader.read(rect);
+        ASSERT_EQ(read.getSize(), rect.size());
+        for(int y = 0; y < rect.height; y++){
+            for(int x = 0; x < rect.width; x++){
+                const cv::Point cell(rect.x + x, rect.y + y);
+                const bool inside = cell.x >= 0 && cell.y >= 0 && cell.x < map.getSize().width && cell.y < map.getSize().height;
+                ASSERT_EQ(read.get(x, y), inside ? map.get(cell.x, cell.y) : 0u) << "cell (" << cell.x << ", " << cell.y << ")";
+            }
+        }
+    }
+
+    EXPECT_THROW(reader.read(cv::Rect(0, 0, -1, 5)), std::runtime_error);
+    EXPECT_THROW(reader.read(cv::Rect(0, 0, 1 << 20, 1 << 20)), std::runtime_error);
+}
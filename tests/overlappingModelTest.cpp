@@ -0,0 +1,74 @@
+#include "testUtils.h"
+#include "../include/overlappingModel.h"
+#include "../include/wfcSolver.h"
+
+namespace{
+    //color of pixel is chosen by function of its coordinates
+    template<typename Color>
+    cv::Mat makeSample(cv::Size size, Color&& color){
+        cv::Mat sample(size, CV_8UC4);
+        const cv::Vec4b colors[] = {{255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}};
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                sample.at<cv::Vec4b>(y, x) = colors[color(x, y)];
+            }
+        }
+        return sample;
+    }
+}
+
+TEST(OverlappingModel, PatternsOfSample){
+    OverlappingConfig config;
+    config.patternSize = 2;
+    EXPECT_EQ(OverlappingModel(makeSample({5, 5}, [](int, int){ return 0; }), config).getPatternsCount(), 1u);
+
+    //vertical stripes: two patterns, and two more horizontal patterns from rotations
+    const cv::Mat stripes = makeSample({4, 4}, [](int x, int){ return x % 2; });
+    config.rotations = false;
+    config.reflections = false;
+    const OverlappingModel model(stripes, config);
+    ASSERT_EQ(model.getPatternsCount(), 2u);
+    //every position of periodic sample is counted
+    EXPECT_EQ(model.getPatternCount(0) + model.getPatternCount(1), 16u);
+    config.rotations = true;
+    EXPECT_EQ(OverlappingModel(stripes, config).getPatternsCount(), 4u);
+}
+
+TEST(OverlappingModel, OutputIsMadeOfSamplePatterns){
+    OverlappingConfig config;
+    config.patternSize = 3;
+    const OverlappingModel model(makeSample({9, 9}, [](int x, int y){ return (x / 2 + y) % 3; }), config);
+    TileSet tileSet = model.createTileSet();
+    ASSERT_EQ(tileSet.getAdjacency().getTilesCount(), model.getPatternsCount());
+
+    //pixel (dx, dy) of pattern of cell is the first pixel of pattern of cell (x + dx, y + dy)
+    const int n = config.patternSize;
+    const cv::Size size(20, 20);
+    WfcSolver solver(tileSet);
+    size_t windows = 0;
+    for(uint64_t seed: {1, 2}){
+        solver.reset(size);
+        solver.run(seed);
+        for(int y = 0; y + n <= size.height; y++){
+            for(int x = 0; x + n <= size.width; x++){
+                bool filled = true;
+                for(int dy = 0; dy < n; dy++){
+                    for(int dx = 0; dx < n; dx++){
+                        filled = filled && solver.getCell(x + dx, y + dy) != 0;
+                    }
+                }
+                if(!filled) continue;
+                windows++;
+
+                const uint32_t* pattern = model.getPattern(solver.getCell(x, y) - 1);
+                for(int dy = 0; dy < n; dy++){
+                    for(int dx = 0; dx < n; dx++){
+                        ASSERT_EQ(pattern[dy * n + dx], model.getPattern(solver.getCell(x + dx, y + dy) - 1)[0])
+                            << "window (" << x << ", " << y << "), pixel (" << dx << ", " << dy << ")";
+                    }
+                }
+            }
+        }
+    }
+    EXPECT_GT(windows, 0u);
+}
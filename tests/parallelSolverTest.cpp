@@ -0,0 +1,56 @@
+#include "testUtils.h"
+#include "../include/parallelSolver.h"
+
+namespace{
+    //small regions, so map has many borders of regions and crossings of seams
+    ParallelConfig smallRegions(size_t threads){
+        ParallelConfig config;
+        config.threads = threads;
+        config.regionSize = 8;
+        config.seamWidth = 2;
+        return config;
+    }
+}
+
+TEST(ParallelSolver, SeamsFit){
+    for(const auto& tiles: {test::SET_1, test::SET_2}){
+        TileSet tileSet = test::makeTileSet(tiles);
+        ParallelSolver solver(tileSet, smallRegions(4));
+        //size isn't multiple of regions, so the last regions are cut,
+        //in the second size the last regions are narrower than seam and they are only in crossings
+        for(const cv::Size size: {cv::Size(53, 37), cv::Size(25, 17)}){
+            for(uint64_t seed: {1, 2}){
+                TileIdGrid map;
+                const WfcStats stats = solver.solve(map, size, seed);
+                EXPECT_EQ(stats.holes, 0u);
+                ASSERT_EQ(map.getSize(), size);
+                test::expectValidMap(tileSet, size, [&](int x, int y){ return map.get(x, y); });
+            }
+        }
+    }
+}
+
+TEST(ParallelSolver, SameMapForAnyThreads){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    ParallelSolver single(tileSet, smallRegions(1));
+    ParallelSolver several(tileSet, smallRegions(4));
+    TileIdGrid expected, map;
+    single.solve(expected, {40, 40}, 9);
+    several.solve(map, {40, 40}, 9);
+    for(int y = 0; y < 40; y++){
+        for(int x = 0; x < 40; x++){
+            ASSERT_EQ(map.get(x, y), expected.get(x, y)) << "cell (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(ParallelSolver, EmptyMap){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    ParallelSolver solver(tileSet, smallRegions(2));
+    for(const cv::Size size: {cv::Size(0, 10), cv::Size(10, 0), cv::Size(0, 0)}){
+        TileIdGrid map;
+        const WfcStats stats = solver.solve(map, size, 1);
+        EXPECT_EQ(map.getSize(), size);
+        EXPECT_EQ(stats.collapses, 0u);
+    }
+}
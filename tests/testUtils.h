@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include <filesystem>
+#include <vector>
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include "../include/tilesMap.h"
+
+//helpers shared by tests, tile sets are built in code, so tests don't depend on decoding of images
+namespace test{
+    struct TileDesc{
+        const char* sides; //features of up, right, bottom and left sides
+        uint32_t chanse;
+    };
+
+    //sides and chanses of tiles of bundled data/set_1
+    inline const std::vector<TileDesc> SET_1 = {
+        {"0000", 300}, {"0101", 100}, {"1001", 0}, {"1111", 100}, {"0100", 0}, {"1011", 0}
+    };
+    //sides and chanses of tiles of bundled data/set_2
+    inline const std::vector<TileDesc> SET_2 = {
+        {"0000", 5}, {"1010", 1}, {"0110", 1}, {"1111", 1}, {"1110", 1}, {"0010", 1}
+    };
+    //only empty tiles and corners, so lines have to close into loops and random choices contradict often
+    inline const std::vector<TileDesc> LOOPS = {
+        {"0000", 1}, {"1100", 1}
+    };
+
+    //file in temporary directory which is removed by destructor
+    class TempFile{
+    private:
+        std::filesystem::path m_path;
+
+    public:
+        TempFile(const std::string& name)
+                :m_path(std::filesystem::temp_directory_path() / ("mapGeneratorTest_" + name)){
+            std::filesystem::remove(m_path);
+        }
+        ~TempFile(){
+            std::error_code error;
+            std::filesystem::remove(m_path, error);
+        }
+
+        std::string getPath() const{ return m_path.string(); }
+    };
+
+    //image of its own color which isn't symmetric, so rotated variants of tile differ by pixels
+    inline TileImage makeImage(cv::Size size, int color){
+        TileImage img;
+        img.getImage() = cv::Mat(size, CV_8UC4);
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                img.getImage().at<cv::Vec4b>(y, x) = cv::Vec4b(color, x * 255 / size.width, y * 255 / size.height, 255);
+            }
+        }
+        return img;
+    }
+
+    //tile set of one feature with 4x4 images, every tile is added with its rotations
+    inline TileSet makeTileSet(const std::vector<TileDesc>& tiles){
+        TileSet tileSet(1, {4, 4});
+        int color = 0;
+        for(const auto& tile: tiles){
+            tileSet.addTile(Tile(makeImage({4, 4}, color), TileSides(1, tile.sides), tile.chanse));
+            color += 40;
+        }
+        tileSet.getAdjacency();
+        return tileSet;
+    }
+
+    //check that map has no empty cells and sides of every pair of neighbour cells are equal
+    //get(x, y) - tile id + 1 of cell or 0 for empty cell
+    template<typename Getter>
+    void expectValidMap(TileSet& tileSet, cv::Size size, Getter&& get){
+        for(int y = 0; y < size.height; y++){
+            for(int x = 0; x < size.width; x++){
+                const size_t cell = get(x, y);
+                ASSERT_NE(cell, 0u) << "empty cell (" << x << ", " << y << ")";
+                const auto sides = tileSet.getTileById(cell - 1).getSides();
+                if(x + 1 < size.width && get(x + 1, y) != 0){
+                    ASSERT_EQ(sides[1], tileSet.getTileById(get(x + 1, y) - 1).getSides()[3])
+                        << "cells (" << x << ", " << y << ") and (" << x + 1 << ", " << y << ") don't fit";
+                }
+                if(y + 1 < size.height && get(x, y + 1) != 0){
+                    ASSERT_EQ(sides[2], tileSet.getTileById(get(x, y + 1) - 1).getSides()[0])
+                        << "cells (" << x << ", " << y << ") and (" << x << ", " << y + 1 << ") don't fit";
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include "testUtils.h"
+#include "../include/tileAdjacency.h"
+
+namespace{
+    //mask of every (direction, side) should hold exactly tiles with this side in the direction
+    void expectMasksMatchSides(const TileAdjacency& adjacency, const std::vector<std::array<std::string, 4>>& tileSides){
+        ASSERT_EQ(adjacency.getTilesCount(), tileSides.size());
+        for(uint32_t dir = 0; dir < 4; dir++){
+            for(uint32_t side = 0; side < adjacency.getSidesCount(); side++){
+                const uint64_t* mask = adjacency.getMask(dir, side);
+                for(size_t id = 0; id < tileSides.size(); id++){
+                    EXPECT_EQ(TileAdjacency::testBit(mask, id), tileSides[id][dir] == adjacency.getSideName(side))
+                        << "tile " << id << ", direction " << dir << ", side \"" << adjacency.getSideName(side) << "\"";
+                }
+            }
+        }
+    }
+}
+
+TEST(TileAdjacency, MasksMatchSides){
+    //more than 64 tiles, so masks take several words
+    std::vector<std::array<std::string, 4>> tileSides;
+    const char* features[] = {"a", "b", "c"};
+    for(int i = 0; i < 81; i++){
+        tileSides.push_back({features[i % 3], features[i / 3 % 3], features[i / 9 % 3], features[i / 27 % 3]});
+    }
+    TileAdjacency adjacency;
+    adjacency.build(tileSides);
+    EXPECT_EQ(adjacency.getWordsCount(), 2u);
+    EXPECT_EQ(adjacency.getSidesCount(), 3u);
+    expectMasksMatchSides(adjacency, tileSides);
+}
+
+TEST(TileAdjacency, Candidates){
+    TileAdjacency adjacency;
+    adjacency.build({{"a", "b", "a", "b"}, {"a", "a", "b", "b"}, {"b", "b", "b", "b"}});
+    std::vector<uint64_t> result(adjacency.getWordsCount());
+
+    //without neighbours every tile fits
+    const uint32_t none = TileAdjacency::NO_SIDE;
+    ASSERT_TRUE(adjacency.getCandidates({none, none, none, none}, result.data()));
+    EXPECT_EQ(TileAdjacency::countBits(result.data(), result.size()), 3u);
+
+    //upper neighbour has bottom side "a" and left neighbour has right side "b"
+    ASSERT_TRUE(adjacency.getCandidates({adjacency.getSideId("a"), none, none, adjacency.getSideId("b")}, result.data()));
+    EXPECT_EQ(TileAdjacency::countBits(result.data(), result.size()), 2u);
+    EXPECT_TRUE(TileAdjacency::testBit(result.data(), 0));
+    EXPECT_TRUE(TileAdjacency::testBit(result.data(), 1));
+
+    EXPECT_FALSE(adjacency.getCandidates({adjacency.getSideId("b"), adjacency.getSideId("a"), none, none}, result.data()));
+    EXPECT_EQ(adjacency.getSideId("c"), TileAdjacency::UNKNOWN_SIDE);
+    EXPECT_FALSE(adjacency.getCandidates({TileAdjacency::UNKNOWN_SIDE, none, none, none}, result.data()));
+}
+
+TEST(TileAdjacency, TileSetIndex){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const TileAdjacency& adjacency = tileSet.getAdjacency();
+    std::vector<std::array<std::string, 4>> tileSides;
+    for(size_t id = 0; id < adjacency.getTilesCount(); id++){
+        tileSides.push_back(tileSet.getTileById(id).getSides());
+        for(uint32_t dir = 0; dir < 4; dir++){
+            EXPECT_EQ(adjacency.getSideName(adjacency.getTileSide(id, dir)), tileSides.back()[dir]);
+        }
+    }
+    //every rotation of every tile is in tile set
+    for(const auto& tile: test::SET_2){
+        for(int rotation = 0; rotation < 4; rotation++){
+            std::array<std::string, 4> sides;
+            for(int dir = 0; dir < 4; dir++){
+                sides[(dir + rotation) % 4] = std::string(1, tile.sides[dir]);
+            }
+            EXPECT_NE(std::find(tileSides.begin(), tileSides.end(), sides), tileSides.end()) << tile.sides << " rotated " << rotation << " times";
+        }
+    }
+    expectMasksMatchSides(adjacency, tileSides);
+}
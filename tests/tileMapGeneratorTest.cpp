@@ -0,0 +1,44 @@
+#include <cstring>
+#include "testUtils.h"
+
+namespace{
+    //tiles of set_1 with other colors, so tile set has the same tiles count and other images
+    TileSet recoloredSet1(){
+        TileSet tileSet(1, {4, 4});
+        int color = 20;
+        for(const auto& tile: test::SET_1){
+            tileSet.addTile(Tile(test::makeImage({4, 4}, color), TileSides(1, tile.sides), tile.chanse));
+            color += 40;
+        }
+        return tileSet;
+    }
+
+    bool equalImages(const cv::Mat& image, const cv::Mat& expected){
+        if(image.size() != expected.size() || image.type() != expected.type()) return false;
+        for(int y = 0; y < image.rows; y++){
+            if(std::memcmp(image.ptr(y), expected.ptr(y), image.cols * image.elemSize()) != 0) return false;
+        }
+        return true;
+    }
+}
+
+TEST(TileMapGenerator, AtlasFollowsTileSet){
+    TileSet first = test::makeTileSet(test::SET_1);
+    TileSet second = recoloredSet1();
+    ASSERT_EQ(first.getAdjacency().getTilesCount(), second.getAdjacency().getTilesCount());
+    ASSERT_NE(first.getHash(), second.getHash());
+
+    TileMapGenerator fresh;
+    fresh.generateMapWfc(second, {12, 9}, 3);
+    const cv::Mat expected = fresh.getMap().clone();
+
+    //atlas of the first tile set is reused for the same tile set and replaced for other one
+    TileMapGenerator generator;
+    generator.generateMapWfc(first, {12, 9}, 3);
+    const cv::Mat firstMap = generator.getMap().clone();
+    generator.generateMapWfc(first, {12, 9}, 3);
+    EXPECT_TRUE(equalImages(generator.getMap(), firstMap));
+    generator.generateMapWfc(second, {12, 9}, 3);
+    EXPECT_TRUE(equalImages(generator.getMap(), expected));
+    EXPECT_FALSE(equalImages(expected, firstMap));
+}
@@ -0,0 +1,114 @@
+#include <cmath>
+#include <random>
+#include "testUtils.h"
+#include "../include/tileSampler.h"
+
+namespace{
+    //100 tiles, so masks take two words, some tiles have zero chanse
+    std::vector<uint32_t> makeWeights(){
+        std::vector<uint32_t> weights(100);
+        for(size_t i = 0; i < weights.size(); i++){
+            weights[i] = i % 7 == 3 ? 0 : static_cast<uint32_t>(i % 5 + 1) * 10;
+        }
+        return weights;
+    }
+
+    std::vector<uint64_t> makeMask(const std::vector<size_t>& ids){
+        std::vector<uint64_t> mask(2, 0);
+        for(size_t id: ids) mask[id >> 6] |= uint64_t(1) << (id & 63);
+        return mask;
+    }
+
+    //frequency of every id should be close to its share of total weight of ids
+    template<typename Sample>
+    void expectFrequencies(const std::vector<uint32_t>& weights, const std::vector<size_t>& ids, Sample&& sample){
+        const size_t samples = 200000;
+        std::vector<size_t> counts(weights.size(), 0);
+        for(size_t i = 0; i < samples; i++){
+            const size_t id = sample();
+            ASSERT_LT(id, weights.size());
+            counts[id]++;
+        }
+
+        uint64_t totalWeight = 0;
+        for(size_t id: ids) totalWeight += weights[id];
+        size_t inIds = 0;
+        for(size_t id: ids){
+            inIds += counts[id];
+            //zero chanses are equiprobable only when all ids have zero chanse
+            const double expected = totalWeight ? static_cast<double>(weights[id]) / totalWeight : 1.0 / ids.size();
+            const double frequency = static_cast<double>(counts[id]) / samples;
+            //5 standard deviations of binomial distribution
+            EXPECT_NEAR(frequency, expected, 5 * std::sqrt(expected * (1 - expected) / samples) + 1e-9) << "tile " << id;
+        }
+        EXPECT_EQ(inIds, samples) << "tile out of mask was chosen";
+    }
+}
+
+TEST(TileSampler, AllTiles){
+    const auto weights = makeWeights();
+    TileSampler sampler;
+    sampler.build(weights);
+    std::vector<size_t> ids(weights.size());
+    for(size_t i = 0; i < ids.size(); i++) ids[i] = i;
+    Rng rng(1);
+    expectFrequencies(weights, ids, [&]{ return sampler.sample(rng); });
+}
+
+TEST(TileSampler, ZeroChansesAreNeverChosen){
+    //tile 0 has zero chanse, so alias of every column shouldn't fall back to it
+    const std::vector<uint32_t> weights = {0, 0, 7, 1, 0, 3};
+    TileSampler sampler;
+    sampler.build(weights);
+    Rng rng(5);
+    expectFrequencies(weights, {2, 3, 5}, [&]{ return sampler.sample(rng); });
+
+    //random weights with zero chanses at any position
+    std::mt19937 random(5);
+    for(int table = 0; table < 200; table++){
+        std::vector<uint32_t> randomWeights(random() % 50 + 1);
+        for(auto& weight: randomWeights) weight = random() % 3 == 0 ? 0 : random() % 1000;
+        randomWeights.back() = 1;
+        sampler.build(randomWeights);
+        for(int i = 0; i < 1000; i++){
+            ASSERT_NE(randomWeights[sampler.sample(rng)], 0u) << "table " << table;
+        }
+    }
+}
+
+TEST(TileSampler, FrequenciesUnderMask){
+    const auto weights = makeWeights();
+    TileSampler sampler;
+    sampler.build(weights);
+    Rng rng(2);
+    //mask with most of weight is sampled from alias table, mask with small share of weight by fallback
+    const std::vector<std::vector<size_t>> masks = {
+        [&]{ std::vector<size_t> ids; for(size_t i = 0; i < 100; i++) if(i != 50) ids.push_back(i); return ids; }(),
+        {1, 3, 10, 64, 65, 99},
+        {17, 81}
+    };
+    for(const auto& ids: masks){
+        const auto mask = makeMask(ids);
+        expectFrequencies(weights, ids, [&]{ return sampler.sample(mask.data(), mask.size(), rng); });
+        expectFrequencies(weights, ids, [&]{ return sampler.sampleIds(ids.data(), ids.size(), rng); });
+    }
+}
+
+TEST(TileSampler, ZeroChansesAreEquiprobable){
+    const auto weights = makeWeights();
+    TileSampler sampler;
+    sampler.build(weights);
+    Rng rng(3);
+    const std::vector<size_t> ids = {3, 10, 66, 94};
+    const auto mask = makeMask(ids);
+    expectFrequencies(weights, ids, [&]{ return sampler.sample(mask.data(), mask.size(), rng); });
+}
+
+TEST(TileSampler, EmptyMask){
+    TileSampler sampler;
+    sampler.build(makeWeights());
+    Rng rng(4);
+    const auto mask = makeMask({});
+    EXPECT_EQ(sampler.sample(mask.data(), mask.size(), rng), TileSampler::NOT_FOUND);
+    EXPECT_EQ(sampler.sampleIds(nullptr, 0, rng), TileSampler::NOT_FOUND);
+}
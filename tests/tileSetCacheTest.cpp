@@ -0,0 +1,99 @@
+#include <cstring>
+#include "testUtils.h"
+
+namespace{
+    void expectEqualImages(const cv::Mat& image, const cv::Mat& expected){
+        ASSERT_EQ(image.size(), expected.size());
+        ASSERT_EQ(image.type(), expected.type());
+        for(int y = 0; y < image.rows; y++){
+            ASSERT_EQ(std::memcmp(image.ptr(y), expected.ptr(y), image.cols * image.elemSize()), 0) << "row " << y;
+        }
+    }
+}
+
+TEST(TileSetCache, RoundTrip){
+    for(const auto& tiles: {test::SET_1, test::SET_2}){
+        TileSet tileSet = test::makeTileSet(tiles);
+        test::TempFile file("roundTrip.cache");
+        tileSet.saveCache(file.getPath());
+
+        TileSet loaded = TileSet::loadCache(file.getPath());
+        EXPECT_EQ(loaded.getHash(), tileSet.getHash());
+        EXPECT_EQ(loaded.getTileSize(), tileSet.getTileSize());
+        const size_t tilesCount = tileSet.getAdjacency().getTilesCount();
+        ASSERT_EQ(loaded.getAdjacency().getTilesCount(), tilesCount);
+        for(size_t id = 0; id < tilesCount; id++){
+            SCOPED_TRACE("tile " + std::to_string(id));
+            EXPECT_EQ(loaded.getTileById(id).getSides(), tileSet.getTileById(id).getSides());
+            EXPECT_EQ(loaded.getTileById(id).getChanse(), tileSet.getTileById(id).getChanse());
+            expectEqualImages(loaded.getTileById(id).getImage(), tileSet.getTileById(id).getImage());
+        }
+    }
+}
+
+TEST(TileSetCache, DirectedRules){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    EdgeCompatibility compatibility;
+    compatibility.allowDirected("2", "1");
+    compatibility.allow("0", "3");
+    tileSet.setCompatibility(compatibility);
+    const TileAdjacency& adjacency = tileSet.getAdjacency();
+    test::TempFile file("directedRules.cache");
+    tileSet.saveCache(file.getPath());
+
+    TileSet loaded = TileSet::loadCache(file.getPath());
+    EXPECT_EQ(loaded.getHash(), tileSet.getHash());
+    EXPECT_EQ(loaded.getCompatibility().getRules(), compatibility.getRules());
+    const TileAdjacency& loadedAdjacency = loaded.getAdjacency();
+    ASSERT_EQ(loadedAdjacency.getSidesCount(), adjacency.getSidesCount());
+    for(uint32_t side = 0; side < adjacency.getSidesCount(); side++){
+        EXPECT_EQ(loadedAdjacency.getSideName(side), adjacency.getSideName(side));
+        for(uint32_t dir = 0; dir < 4; dir++){
+            EXPECT_EQ(std::memcmp(loadedAdjacency.getMask(dir, side), adjacency.getMask(dir, side), adjacency.getWordsCount() * sizeof(uint64_t)), 0)
+                << "side \"" << adjacency.getSideName(side) << "\", direction " << dir;
+        }
+    }
+}
+
+TEST(TileSetCache, HashFollowsChanges){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    const uint64_t hash = tileSet.getHash();
+    EXPECT_EQ(tileSet.getHash(), hash);
+
+    EdgeCompatibility compatibility;
+    compatibility.allow("0", "1");
+    tileSet.setCompatibility(compatibility);
+    const uint64_t withRules = tileSet.getHash();
+    EXPECT_NE(withRules, hash);
+
+    tileSet.addTile(Tile(test::makeImage({4, 4}, 250), TileSides(1, "0001"), 1));
+    EXPECT_NE(tileSet.getHash(), withRules);
+}
+
+TEST(TileSetCache, CorruptedFile){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    test::TempFile file("corrupted.cache");
+    tileSet.saveCache(file.getPath());
+    std::filesystem::resize_file(file.getPath(), std::filesystem::file_size(file.getPath()) / 2);
+    EXPECT_THROW(TileSet::loadCache(file.getPath()), std::runtime_error);
+}
+
+TEST(TileSetCache, TilesOutliveTileSet){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    test::TempFile file("outlive.cache");
+    tileSet.saveCache(file.getPath());
+
+    //images of tiles are views of mapping of cache, copies of tiles keep it open
+    std::vector<Tile> tiles;
+    {
+        TileSet loaded = TileSet::loadCache(file.getPath());
+        for(size_t id = 0; id < loaded.getAdjacency().getTilesCount(); id++){
+            tiles.push_back(loaded.getTileById(id));
+        }
+    }
+    ASSERT_EQ(tiles.size(), tileSet.getAdjacency().getTilesCount());
+    for(size_t id = 0; id < tiles.size(); id++){
+        SCOPED_TRACE("tile " + std::to_string(id));
+        expectEqualImages(tiles[id].getImage(), tileSet.getTileById(id).getImage());
+    }
+}
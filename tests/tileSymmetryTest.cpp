@@ -0,0 +1,31 @@
+#include "testUtils.h"
+
+namespace{
+    //count of tiles after adding one tile with symmetry
+    //image and sides aren't symmetric, so all variants of symmetry are different
+    size_t variantsCount(TileSymmetry symmetry){
+        TileSet tileSet(1, {3, 3});
+        tileSet.addTile(Tile(test::makeImage({3, 3}, 0), TileSides(1, "1000"), 1), symmetry);
+        return tileSet.getAdjacency().getTilesCount();
+    }
+}
+
+TEST(TileSymmetry, VariantsCount){
+    EXPECT_EQ(variantsCount(TileSymmetry::X), 1u);
+    EXPECT_EQ(variantsCount(TileSymmetry::I), 2u);
+    EXPECT_EQ(variantsCount(TileSymmetry::Backslash), 2u);
+    EXPECT_EQ(variantsCount(TileSymmetry::L), 4u);
+    EXPECT_EQ(variantsCount(TileSymmetry::T), 4u);
+    EXPECT_EQ(variantsCount(TileSymmetry::F), 8u);
+    EXPECT_EQ(variantsCount(TileSymmetry::Rotations), 4u);
+    EXPECT_EQ(variantsCount(TileSymmetry::None), 1u);
+}
+
+TEST(TileSymmetry, EqualRotationsAreMerged){
+    //the same image and sides after any rotation
+    TileSet tileSet(1, {3, 3});
+    TileImage img;
+    img.getImage() = cv::Mat(3, 3, CV_8UC4, cv::Scalar(10, 20, 30, 255));
+    tileSet.addTile(Tile(img, TileSides(1, "1111"), 1), TileSymmetry::Rotations);
+    EXPECT_EQ(tileSet.getAdjacency().getTilesCount(), 1u);
+}
@@ -0,0 +1,68 @@
+#include "testUtils.h"
+#include "../include/wfcSolver.h"
+
+TEST(WfcSolver, ValidMap){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    WfcSolver solver(tileSet);
+    for(uint32_t seed: {1, 2, 3}){
+        solver.reset({40, 30});
+        const WfcStats stats = solver.run(seed);
+        EXPECT_EQ(stats.holes, 0u) << "seed " << seed;
+        test::expectValidMap(tileSet, {40, 30}, [&](int x, int y){ return solver.getCell(x, y); });
+    }
+}
+
+TEST(WfcSolver, SameSeedSameMap){
+    TileSet tileSet = test::makeTileSet(test::SET_2);
+    WfcSolver first(tileSet), second(tileSet);
+    first.reset({32, 32});
+    second.reset({32, 32});
+    first.run(7);
+    second.run(7);
+    for(int y = 0; y < 32; y++){
+        for(int x = 0; x < 32; x++){
+            ASSERT_EQ(first.getCell(x, y), second.getCell(x, y)) << "cell (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(WfcSolver, BacktrackingResolvesContradictions){
+    TileSet tileSet = test::makeTileSet(test::LOOPS);
+    for(RestartPolicy policy: {RestartPolicy::FullRestart, RestartPolicy::LocalRegion}){
+        WfcConfig config;
+        config.restartPolicy = policy;
+        WfcSolver solver(tileSet, config);
+        size_t backtracks = 0;
+        for(uint32_t seed = 1; seed <= 5; seed++){
+            solver.reset({30, 30});
+            const WfcStats stats = solver.run(seed);
+            EXPECT_EQ(stats.holes, 0u) << "seed " << seed;
+            backtracks += stats.backtracks;
+            test::expectValidMap(tileSet, {30, 30}, [&](int x, int y){ return solver.getCell(x, y); });
+        }
+        EXPECT_GT(backtracks, 0u);
+    }
+}
+
+TEST(WfcSolver, WithoutBacktrackingContradictionsAreHoles){
+    TileSet tileSet = test::makeTileSet(test::LOOPS);
+    WfcConfig config;
+    config.maxBacktracks = 0;
+    config.maxRestarts = 0;
+    WfcSolver solver(tileSet, config);
+    size_t holes = 0;
+    for(uint32_t seed = 1; seed <= 10; seed++){
+        solver.reset({30, 30});
+        const WfcStats stats = solver.run(seed);
+        EXPECT_EQ(stats.backtracks, 0u);
+        size_t empty = 0;
+        for(int y = 0; y < 30; y++){
+            for(int x = 0; x < 30; x++){
+                empty += solver.getCell(x, y) == 0;
+            }
+        }
+        EXPECT_EQ(stats.holes, empty) << "seed " << seed;
+        holes += stats.holes;
+    }
+    EXPECT_GT(holes, 0u);
+}